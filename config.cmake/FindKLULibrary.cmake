@@ -0,0 +1,36 @@
+# Finds the sparse direct solver KLU of SuiteSparse and its dependencies.
+
+find_path(KLULibrary_INCLUDEDIR
+  NAMES klu.h
+  HINTS ${KLULibrary_ROOT}/include
+  PATH_SUFFIXES suitesparse
+)
+
+set(KLULibrary_LIBRARIES "")
+foreach(lib klu amd colamd btf suitesparseconfig)
+  find_library(KLULibrary_${lib}_LIBRARY
+    NAMES ${lib}
+    HINTS ${KLULibrary_ROOT}/lib
+  )
+  if(KLULibrary_${lib}_LIBRARY)
+    list(APPEND KLULibrary_LIBRARIES ${KLULibrary_${lib}_LIBRARY})
+  else()
+    set(KLULibrary_MISSING ${KLULibrary_MISSING} ${lib})
+  endif()
+endforeach()
+
+if(KLULibrary_INCLUDEDIR AND NOT KLULibrary_MISSING)
+  set(KLULibrary_FOUND TRUE)
+  message(STATUS "Found KLU")
+  message(STATUS "  KLULibrary_ROOT:       " ${KLULibrary_ROOT})
+  message(STATUS "  KLULibrary_LIBRARIES:  " "${KLULibrary_LIBRARIES}")
+  message(STATUS "  KLULibrary_INCLUDEDIR: " ${KLULibrary_INCLUDEDIR})
+else()
+  if(KLULibrary_FIND_REQUIRED)
+    message(STATUS "Unable to find the requested KLULibrary" )
+    message(STATUS "Looked in KLULibrary_ROOT ${KLULibrary_ROOT} and the system paths" )
+    message(FATAL_ERROR "Could not find KLU (missing: ${KLULibrary_MISSING}). Set KLULibrary_ROOT to your SuiteSparse installation or disable OMS_WITH_KLU." )
+  else()
+    message(STATUS "KLULibrary - NOT Found" )
+  endif(KLULibrary_FIND_REQUIRED)
+endif()
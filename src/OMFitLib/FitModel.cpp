@@ -30,10 +30,14 @@
  */
 #include <string>
 #include <chrono>
+#include <cmath>
+#include <atomic>
+#include <mutex>
 
 #include "FitModel.h"
 #include "OMSimulatorLib/OMSimulator.h"
 #include "OMSimulatorLib/Logging.h"
+#include "OMSimulatorLib/ThreadPool.h"
 
 #include "ceres/ceres.h"
 #include "glog/logging.h"
@@ -69,42 +73,86 @@ std::string seriesPropertiesString(std::string var, std::vector<SeriesMap> serie
   return ss.str();
 }
 
-struct OdeResidual {
-  OdeResidual(double t, std::vector<VarValueMap> mes,
-    std::vector<VarValueMap> input, std::set<std::string> params, void* model)
-      : t_(t), mes_(mes), input_(input), params_(params), model_(model) {}
+/**
+ * Residual of a whole trajectory: The model is simulated once per
+ * parameter vector and sampled at all measurement time points.
+ * Residuals are ordered by time, then series, then measured variable.
+ */
+struct TrajectoryResidual {
+  TrajectoryResidual(const std::vector<double>& time, const MeasurementData& mdata,
+    const std::set<std::string>& params, void* model)
+      : time_(time), nSeries_(mdata.nSeries), model_(model) {
+    // precondition: order in 'parameters' corresponds to params_ set order
+    for (auto& varname: params) {
+      paramHandles_.push_back(oms_getVariableHandle(model_, varname.c_str()));
+    }
+    for (auto& varname: mdata.measurementVars) {
+      mesHandles_.push_back(oms_getVariableHandle(model_, varname.c_str()));
+    }
+    mes_.resize(time_.size() * mdata.nSeries * mesHandles_.size());
+    int k = 0;
+    for (int i=0; i < time_.size(); ++i) {
+      for (int s=0; s < mdata.nSeries; ++s) {
+        for (auto& varname: mdata.measurementVars) {
+          mes_[k++] = mdata.measurementSeries[s].at(varname)[i];
+        }
+      }
+    }
+  }
+
+  int numResiduals() const { return mes_.size(); }
+
+  /** Enables the forward sensitivities of the model for evaluating the jacobian */
+  bool enableSensitivities() {
+    return oms_status_ok == oms_setSensitivityParameters(model_, paramHandles_.data(), paramHandles_.size());
+  }
 
   bool operator()(double const* const* parameters, double* residual) const {
-    {
-      int i = 0;
-      // precondition: order in 'parameters' corresponds to params_ set order
-      for (auto varname: params_) {
-        oms_setReal(model_, varname.c_str(), parameters[i][0]);
-        i++;
-      }
+    return evaluate(parameters, residual, NULL);
+  }
+
+  /**
+   * Evaluates the residual and, if jacobians isn't NULL, its derivative
+   * from the sensitivities of the simulation (see enableSensitivities).
+   */
+  bool evaluate(double const* const* parameters, double* residual, double** jacobians) const {
+    for (int i=0; i < paramHandles_.size(); ++i) {
+      oms_setRealByHandle(model_, paramHandles_[i], parameters[i][0]);
     }
-    oms_setStopTime(model_, t_); // needed?
+    oms_setStopTime(model_, time_.back());
 
-    oms_initialize(model_);
-    // TODO Replace below by a loop that sets inputs if inputs are available
-    oms_stepUntil(model_, t_);
+    if (oms_status_ok != oms_initialize(model_)) {
+      oms_reset(model_);
+      return false;
+    }
 
-    int nMesVars = mes_.at(0).size();
-    // get simulation values of observed variables
+    const int nMesVars = mesHandles_.size();
+    const int nParams = paramHandles_.size();
     std::vector<double> x(nMesVars);
-    {
-      int i = 0;
-      for (auto& varValue: mes_.at(0)) {
-        x[i] = oms_getReal(model_, varValue.first.c_str());
-        i++;
+    std::vector<double> dx(jacobians ? nMesVars*nParams : 0);
+    int k = 0;
+    for (int i=0; i < time_.size(); ++i) {
+      // TODO Set inputs if inputs are available
+      if (oms_status_ok != oms_stepUntil(model_, time_[i])) {
+        oms_reset(model_);
+        return false;
       }
-    }
-    // Compute residual by subtracting simulation value from measured value
-    for (int i=0; i < mes_.size(); ++i) {
-      int j = 0;
-      for (auto& varValue : mes_.at(i)) {
-        residual[i*nMesVars + j] = varValue.second - x.at(j);
-        j++;
+      // get simulation values of observed variables
+      oms_getReals(model_, mesHandles_.data(), nMesVars, x.data());
+      if (jacobians && oms_status_ok != oms_getRealSensitivities(model_, mesHandles_.data(), nMesVars, dx.data())) {
+        oms_reset(model_);
+        return false;
+      }
+      // Compute residual by subtracting simulation value from measured value
+      for (int s=0; s < nSeries_; ++s) {
+        for (int j=0; j < nMesVars; ++j, ++k) {
+          residual[k] = mes_[k] - x[j];
+          for (int p=0; jacobians && p < nParams; ++p) {
+            if (jacobians[p]) {
+              jacobians[p][k] = -dx[j*nParams + p];
+            }
+          }
+        }
       }
     }
 
@@ -113,13 +161,135 @@ struct OdeResidual {
   }
 
  private:
-  const double t_;
-  const std::vector<VarValueMap> mes_;
-  const std::vector<VarValueMap> input_;
-  const std::set<std::string> params_;
+  const std::vector<double> time_;
+  const size_t nSeries_;
+  std::vector<double> mes_;
+  std::vector<int> paramHandles_;
+  std::vector<int> mesHandles_;
   void* model_;
 };
 
+/**
+ * Cost function with an analytic jacobian from the forward sensitivities of
+ * the model, i.e., one simulation per cost and jacobian evaluation.
+ */
+class SensitivityTrajectoryCost : public CostFunction {
+ public:
+  SensitivityTrajectoryCost(TrajectoryResidual* residual, int nParameters)
+      : residual_(residual) {
+    for (int i=0; i < nParameters; ++i) {
+      mutable_parameter_block_sizes()->push_back(1);
+    }
+    set_num_residuals(residual_->numResiduals());
+  }
+
+  ~SensitivityTrajectoryCost() {
+    delete residual_;
+  }
+
+  bool Evaluate(double const* const* parameters, double* residuals, double** jacobians) const override {
+    return residual_->evaluate(parameters, residuals, jacobians);
+  }
+
+ private:
+  TrajectoryResidual* residual_;
+};
+
+/**
+ * Cost function that evaluates the central differences of the Jacobian
+ * concurrently. Each worker thread simulates on its own model instance.
+ * The step size follows Ceres' default for numeric differentiation.
+ */
+class ParallelTrajectoryCost : public CostFunction {
+ public:
+  ParallelTrajectoryCost(const std::vector<TrajectoryResidual*>& residuals, int nParameters)
+      : residuals_(residuals), pool_(residuals.size()) {
+    for (int i=0; i < nParameters; ++i) {
+      mutable_parameter_block_sizes()->push_back(1);
+    }
+    set_num_residuals(residuals_[0]->numResiduals());
+    for (int i=0; i < residuals_.size(); ++i) {
+      idle_.push_back(i);
+    }
+  }
+
+  ~ParallelTrajectoryCost() {
+    for (auto residual: residuals_) {
+      delete residual;
+    }
+  }
+
+  bool Evaluate(double const* const* parameters, double* residuals, double** jacobians) const override {
+    const int nParameters = parameter_block_sizes().size();
+    const int nResiduals = num_residuals();
+    const double relative_step_size = 1e-6;
+
+    // one task for the residual itself and two for each parameter j, whose forward
+    // (backward) perturbation is stored in results[2*j] (results[2*j+1])
+    std::vector<double> steps(nParameters, 0.0);
+    std::vector<std::vector<double> > results(2*nParameters);
+    std::atomic<bool> success(true);
+
+    pool_.push([&]() { if (!evaluate(parameters, -1, 0.0, residuals)) success = false; });
+    for (int j=0; jacobians && j < nParameters; ++j) {
+      if (!jacobians[j])
+        continue;
+      steps[j] = relative_step_size * std::abs(parameters[j][0]);
+      if (steps[j] == 0.0)
+        steps[j] = relative_step_size;
+      for (int k=0; k < 2; ++k) {
+        std::vector<double>& result = results[2*j+k];
+        result.resize(nResiduals);
+        const double step = k == 0 ? steps[j] : -steps[j];
+        pool_.push([&, j, step]() { if (!evaluate(parameters, j, step, result.data())) success = false; });
+      }
+    }
+    pool_.wait();
+
+    if (!success)
+      return false;
+
+    for (int j=0; jacobians && j < nParameters; ++j) {
+      if (!jacobians[j])
+        continue;
+      for (int i=0; i < nResiduals; ++i) {
+        jacobians[j][i] = (results[2*j][i] - results[2*j+1][i]) / (2.0*steps[j]);
+      }
+    }
+    return true;
+  }
+
+ private:
+  // Evaluates the residual on the next idle model with parameter j perturbed by step
+  bool evaluate(double const* const* parameters, int j, double step, double* residual) const {
+    int idx;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      idx = idle_.back();
+      idle_.pop_back();
+    }
+
+    std::vector<double> values(parameter_block_sizes().size());
+    std::vector<const double*> blocks(values.size());
+    for (int i=0; i < values.size(); ++i) {
+      values[i] = parameters[i][0] + (i == j ? step : 0.0);
+      blocks[i] = &values[i];
+    }
+    bool success = (*residuals_[idx])(blocks.data(), residual);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      idle_.push_back(idx);
+    }
+    return success;
+  }
+
+  std::vector<TrajectoryResidual*> residuals_;
+  mutable ThreadPool pool_;
+  mutable std::vector<int> idle_;
+  mutable std::mutex mutex_;
+};
+
 oms_status_t FitModel::solve(const char* reporttype)
 {
   logTrace();
@@ -151,23 +321,59 @@ oms_status_t FitModel::solve(const char* reporttype)
     }
   }
 
-  int size = mdata_.time.size();
-  for (int i=0; i < size; ++i) {
-    std::vector<VarValueMap> mes(mdata_.nSeries);
-    std::vector<VarValueMap> input(0); // Dummy. TODO support inputs
-    for (int j=0; j < mdata_.nSeries; ++j) {
-      for (auto& varValues : mdata_.measurementSeries[j]) {
-        mes[j][varValues.first] = varValues.second[i];
+  for (int i=1; i < mdata_.time.size(); ++i) {
+    if (mdata_.time[i] < mdata_.time[i-1]) {
+      logError("FitModel::solve: Measurement time points need to be in ascending order.");
+      return oms_status_error;
+    }
+  }
+
+  // One residual block for the whole trajectory, i.e., one simulation per cost evaluation.
+  if (use_sensitivities_) {
+    // Analytic jacobian from the sensitivities of the simulation
+    TrajectoryResidual* residual = new TrajectoryResidual(mdata_.time, mdata_, params, model_);
+    if (!residual->enableSensitivities()) {
+      logError("FitModel::solve: The model doesn't support sensitivities for the given parameters");
+      delete residual;
+      return oms_status_error;
+    }
+    problem_.AddResidualBlock(
+        new SensitivityTrajectoryCost(residual, parameters_.size()),
+        NULL,
+        parameter_blocks_);
+  } else if (num_threads_ > 1) {
+    // Independent model instances for evaluating the Jacobian columns concurrently.
+    // They are copied anew for every solve, since model_ may have changed since the last one.
+    for (auto clone: clones_) {
+      oms_unload(clone);
+    }
+    clones_.clear();
+    while (clones_.size() < num_threads_-1) {
+      void* clone = oms_cloneModel(model_);
+      if (!clone) {
+        logError("FitModel::solve: Failed to copy the model for parallel evaluation");
+        return oms_status_error;
       }
+      clones_.push_back(clone);
     }
-    // use numeric differentiation to obtain the derivative (jacobian).
-    DynamicNumericDiffCostFunction<OdeResidual>* cost_function =
-      new DynamicNumericDiffCostFunction<OdeResidual>(
-        new OdeResidual(mdata_.time[i], mes, input, params, model_));
+    std::vector<TrajectoryResidual*> residuals;
+    residuals.push_back(new TrajectoryResidual(mdata_.time, mdata_, params, model_));
+    for (int i=0; i < num_threads_-1; ++i) {
+      residuals.push_back(new TrajectoryResidual(mdata_.time, mdata_, params, clones_[i]));
+    }
+    problem_.AddResidualBlock(
+        new ParallelTrajectoryCost(residuals, parameters_.size()),
+        NULL,
+        parameter_blocks_);
+  } else {
+    // Use numeric differentiation to obtain the derivative (jacobian).
+    TrajectoryResidual* residual = new TrajectoryResidual(mdata_.time, mdata_, params, model_);
+    DynamicNumericDiffCostFunction<TrajectoryResidual>* cost_function =
+      new DynamicNumericDiffCostFunction<TrajectoryResidual>(residual);
     for (int i=0; i < parameters_.size(); ++i) {
       cost_function->AddParameterBlock(1);
     }
-    cost_function->SetNumResiduals(mdata_.measurementVars.size());
+    cost_function->SetNumResiduals(residual->numResiduals());
 
     problem_.AddResidualBlock(
         cost_function,
@@ -181,6 +387,10 @@ oms_status_t FitModel::solve(const char* reporttype)
   Solve(options_, &problem_, &summary);
   auto t1 = high_resolution_clock::now();
 
+  if (use_sensitivities_) {
+    oms_setSensitivityParameters(model_, NULL, 0);
+  }
+
   // Report results
   if (report == "BriefReport")
     std::cout << summary.BriefReport() << "\n";
@@ -223,9 +433,18 @@ FitModel::FitModel(void* model) : model_(model)
   options_.max_num_iterations = 25;
   options_.linear_solver_type = ceres::DENSE_QR;
   options_.minimizer_progress_to_stdout = true;
+  num_threads_ = 1;
+  use_sensitivities_ = false;
   state_ = FitModelState::CONSTRUCTED;
 }
 
+FitModel::~FitModel() noexcept
+{
+  for (auto clone: clones_) {
+    oms_unload(clone);
+  }
+}
+
 oms_status_t FitModel::initialize(size_t nSeries, const double* time, size_t nTime, char const* const* inputvars, size_t nInputvars, char const* const* measurementvars, size_t nMeasurementvars)
 {
   logTrace();
@@ -337,6 +556,23 @@ void FitModel::setOptions_max_num_iterations(size_t max_num_iterations)
   options_.max_num_iterations = max_num_iterations;
 }
 
+oms_status_t FitModel::setOptions_num_threads(size_t num_threads)
+{
+  logTrace();
+  if (num_threads < 1) {
+    logError("FitModel::setOptions_num_threads: Number of threads needs to be at least 1");
+    return oms_status_error;
+  }
+  num_threads_ = num_threads;
+  return oms_status_ok;
+}
+
+void FitModel::setOptions_use_sensitivities(bool use_sensitivities)
+{
+  logTrace();
+  use_sensitivities_ = use_sensitivities;
+}
+
 bool FitModel::isDataComplete() const
 {
   logTrace();
@@ -72,7 +72,7 @@ class FitModel
 {
 public:
   explicit FitModel(void* model);
-  ~FitModel() noexcept {}
+  ~FitModel() noexcept;
   /** Copy constructor */
   FitModel(const FitModel& other) = delete;
   /** Move constructor */
@@ -90,6 +90,8 @@ public:
   oms_status_t getParameter(const char* var, ParameterAttributes& attributes);
   bool isDataComplete() const;
   void setOptions_max_num_iterations(size_t max_num_iterations=25);
+  oms_status_t setOptions_num_threads(size_t num_threads=1);
+  void setOptions_use_sensitivities(bool use_sensitivities=false);
   oms_status_t solve(const char* reporttype="BriefReport");
 
 private:
@@ -101,6 +103,9 @@ private:
   MeasurementData mdata_;
   ceres::Problem problem_;
   ceres::Solver::Options options_;
+  size_t num_threads_;
+  bool use_sensitivities_; // Jacobian from the forward sensitivities of the model instead of finite differences
+  std::vector<void*> clones_; // Independent copies of model_ for concurrent cost function evaluations
 };
 
 #endif // _FIT_MODEL_
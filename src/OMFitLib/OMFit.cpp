@@ -128,6 +128,29 @@ oms_status_t omsfit_setOptions_max_num_iterations(void* fitmodel, size_t max_num
   return oms_status_ok;
 }
 
+oms_status_t omsfit_setOptions_num_threads(void* fitmodel, size_t num_threads)
+{
+  logTrace();
+  if (!fitmodel) {
+    logError("omsfit_setOptions_num_threads: invalid pointer");
+    return oms_status_error;
+  }
+  FitModel* pFitModel = (FitModel*) fitmodel;
+  return pFitModel->setOptions_num_threads(num_threads);
+}
+
+oms_status_t omsfit_setOptions_use_sensitivities(void* fitmodel, int use_sensitivities)
+{
+  logTrace();
+  if (!fitmodel) {
+    logError("omsfit_setOptions_use_sensitivities: invalid pointer");
+    return oms_status_error;
+  }
+  FitModel* pFitModel = (FitModel*) fitmodel;
+  pFitModel->setOptions_use_sensitivities(use_sensitivities != 0);
+  return oms_status_ok;
+}
+
 oms_status_t omsfit_solve(void* fitmodel, const char* reporttype)
 {
   logTrace();
@@ -149,6 +149,34 @@ oms_status_t omsfit_solve(void* fitmodel, const char* reporttype);
  */
 oms_status_t omsfit_setOptions_max_num_iterations(void* fitmodel, size_t max_num_iterations);
 
+/**
+ * \brief Set number of threads for evaluating the cost function.
+ *
+ * With more than one thread, the fitting model works on independent copies of
+ * the composite model (see oms_cloneModel) and simulates the perturbed
+ * parameter vectors for the finite-difference Jacobian concurrently.
+ *
+ * @param fitmodel [inout] Fitting model as opaque pointer.
+ * @param num_threads [in] Number of threads, i.e., model instances (default: 1).
+ * @return Error status.
+ */
+oms_status_t omsfit_setOptions_num_threads(void* fitmodel, size_t num_threads);
+
+/**
+ * \brief Use the forward sensitivities of the model as Jacobian.
+ *
+ * Instead of central differences, the Jacobian is taken from a sensitivity
+ * analysis of the simulation (see oms_setSensitivityParameters), i.e., one
+ * simulation per iteration. All parameters and measured variables need to
+ * belong to the same FMU ME that provides directional derivatives and is
+ * simulated with CVODE.
+ *
+ * @param fitmodel [inout] Fitting model as opaque pointer.
+ * @param use_sensitivities [in] Use sensitivities (1) or finite differences (0, default).
+ * @return Error status.
+ */
+oms_status_t omsfit_setOptions_use_sensitivities(void* fitmodel, int use_sensitivities);
+
 /**
  * \brief Get state of fitting model object.
  *
@@ -255,6 +255,40 @@ static int OMFitLua_omsfit_setOptions_max_num_iterations(lua_State *L)
   return 1;
 }
 
+// oms_status_t omsfit_setOptions_num_threads(void* fitmodel, size_t num_threads);
+static int OMFitLua_omsfit_setOptions_num_threads(lua_State *L)
+{
+  if (lua_gettop(L) != 2)
+    return luaL_error(L, "expecting exactly 2 arguments");
+  luaL_checktype(L, 1, LUA_TUSERDATA); // fitmodel
+  luaL_checktype(L, 2, LUA_TNUMBER);   // num_threads
+
+  void *model = topointer(L, 1);
+  int num_threads = lua_tointeger(L, 2);
+
+  oms_status_t returnValue =
+    omsfit_setOptions_num_threads(model, num_threads);
+  lua_pushinteger(L, returnValue);
+  return 1;
+}
+
+// oms_status_t omsfit_setOptions_use_sensitivities(void* fitmodel, int use_sensitivities);
+static int OMFitLua_omsfit_setOptions_use_sensitivities(lua_State *L)
+{
+  if (lua_gettop(L) != 2)
+    return luaL_error(L, "expecting exactly 2 arguments");
+  luaL_checktype(L, 1, LUA_TUSERDATA); // fitmodel
+  luaL_checktype(L, 2, LUA_TNUMBER);   // use_sensitivities
+
+  void *model = topointer(L, 1);
+  int use_sensitivities = lua_tointeger(L, 2);
+
+  oms_status_t returnValue =
+    omsfit_setOptions_use_sensitivities(model, use_sensitivities);
+  lua_pushinteger(L, returnValue);
+  return 1;
+}
+
 // oms_status_t omsfit_getState(void* fitmodel, omsfit_fitmodelstate_t* state);
 static int OMFitLua_omsfit_getState(lua_State *L)
 {
@@ -289,6 +323,8 @@ DLLEXPORT int luaopen_OMFitLua(lua_State *L)
   REGISTER_LUA_CALL_OMFIT(omsfit_getParameter);
   REGISTER_LUA_CALL_OMFIT(omsfit_solve);
   REGISTER_LUA_CALL_OMFIT(omsfit_setOptions_max_num_iterations);
+  REGISTER_LUA_CALL_OMFIT(omsfit_setOptions_num_threads);
+  REGISTER_LUA_CALL_OMFIT(omsfit_setOptions_use_sensitivities);
   REGISTER_LUA_CALL_OMFIT(omsfit_getState);
   return 0;
 }
@@ -43,6 +43,7 @@ ProgramOptions::ProgramOptions()
 
   resultFile = "";
   tempDir = "";
+  traceFile = "";
   workingDir = "";
   startTime = 0.0;
   useStartTime = false;
@@ -50,6 +51,12 @@ ProgramOptions::ProgramOptions()
   useStopTime = false;
   tolerance = 1e-6;
   useTolerance = false;
+  numProcs = 1;
+  useNumProcs = false;
+  asyncResultFile = false;
+  persistentFMUCache = false;
+  ensembleFile = "";
+  workers = 1;
 }
 
 bool ProgramOptions::load_flags(int argc, char** argv)
@@ -60,14 +67,20 @@ bool ProgramOptions::load_flags(int argc, char** argv)
   boost::program_options::positional_options_description pos_options;
 
   visible_options.add_options()
+  ("asyncResultFile", "Writes the result file in a separate thread.")
   ("describe,d", "Displays brief summary of given model")
+  ("ensemble", boost::program_options::value<std::string>(&ensembleFile), "Simulates the model for each parameter set of the given CSV file (header: parameter names, one run per line).")
   ("help,h", "Displays the help text")
+  ("numProcs,n", boost::program_options::value<int>(&numProcs), "Specifies the number of threads used to step the FMU instances.")
+  ("persistentFMUCache", "Keeps the extracted FMUs in the temp directory and reuses them in later runs.")
   ("resultFile,r", boost::program_options::value<std::string>(&resultFile), "Specifies the name of the output result file")
   ("startTime,s", boost::program_options::value<double>(&startTime), "Specifies the start time.")
   ("stopTime,t", boost::program_options::value<double>(&stopTime), "Specifies the stop time.")
   ("tempDir", boost::program_options::value<std::string>(&tempDir), "Specifies the temp directory.")
   ("tolerance", boost::program_options::value<double>(&tolerance), "Specifies the relative tolerance.")
+  ("trace", boost::program_options::value<std::string>(&traceFile), "Records all time measurements and exports them to the given file (Chrome trace event format).")
   ("version,v", "Displays version information.")
+  ("workers", boost::program_options::value<int>(&workers), "Specifies the number of processes used to simulate an ensemble.")
   ("workingDir", boost::program_options::value<std::string>(&workingDir), "Specifies the working directory.");
 
   hidden_options.add_options()
@@ -152,6 +165,15 @@ bool ProgramOptions::load_flags(int argc, char** argv)
   if (vm.count("tolerance"))
     useTolerance = true;
 
+  if (vm.count("numProcs"))
+    useNumProcs = true;
+
+  if (vm.count("asyncResultFile"))
+    asyncResultFile = true;
+
+  if (vm.count("persistentFMUCache"))
+    persistentFMUCache = true;
+
   return true;
 }
 
@@ -56,9 +56,16 @@ public:
   bool useStopTime;
   double tolerance;
   bool useTolerance;
+  int numProcs;
+  bool useNumProcs;
+  bool asyncResultFile;
+  bool persistentFMUCache;
+  int workers;
+  std::string ensembleFile;
   std::string filename;
   std::string resultFile;
   std::string tempDir;
+  std::string traceFile;
   std::string workingDir;
 };
 
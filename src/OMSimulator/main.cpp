@@ -68,12 +68,20 @@ int main(int argc, char *argv[])
     return 1;
   }
 
+  int returnCode = 0;
+
   if (options.workingDir != "")
     oms_setWorkingDirectory(options.workingDir.c_str());
 
   if (options.tempDir != "")
     oms_setTempDirectory(options.tempDir.c_str());
 
+  if (options.traceFile != "")
+    oms_setTracing(1);
+
+  if (options.persistentFMUCache)
+    oms_setPersistentFMUCache(1);
+
   if (type == "fmu" || type == "xml")
   {
     void* pModel = NULL;
@@ -93,12 +101,30 @@ int main(int argc, char *argv[])
       oms_setStopTime(pModel, options.stopTime);
     if (options.useTolerance)
       oms_setTolerance(pModel, options.tolerance);
+    if (options.useNumProcs)
+      oms_setNumProcs(pModel, options.numProcs);
+    if (options.asyncResultFile)
+      oms_setAsyncResultFile(pModel, 1);
 
     if (options.describe)
     {
       // OMSimulator --describe example.xml
       oms_describe(pModel);
     }
+    else if (options.ensembleFile != "")
+    {
+      // OMSimulator --ensemble parameters.csv --workers 4 example.xml
+      std::string resultFile = options.resultFile;
+      if (resultFile == "")
+      {
+        size_t pos = filename.find_last_of("/\\");
+        std::string stem = filename.substr(pos == std::string::npos ? 0 : pos + 1);
+        resultFile = stem.substr(0, stem.length() - 4) + "_res.mat";
+      }
+      oms_status_t status = oms_runEnsemble(pModel, options.ensembleFile.c_str(), options.workers, resultFile.c_str());
+      if (oms_status_ok != status)
+        returnCode = 1;
+    }
     else
     {
       // OMSimulator example.xml
@@ -119,8 +145,14 @@ int main(int argc, char *argv[])
       std::cout << "Ignoring option '--stopTime'" << std::endl;
     if (options.useTolerance)
       std::cout << "Ignoring option '--tolerance'" << std::endl;
+    if (options.useNumProcs)
+      std::cout << "Ignoring option '--numProcs'" << std::endl;
+    if (options.asyncResultFile)
+      std::cout << "Ignoring option '--asyncResultFile'" << std::endl;
     if (options.describe)
       std::cout << "Ignoring option '--describe'" << std::endl;
+    if (options.ensembleFile != "")
+      std::cout << "Ignoring option '--ensemble'" << std::endl;
 
     lua_State *L = luaL_newstate();
     luaL_openlibs(L);
@@ -147,5 +179,8 @@ int main(int argc, char *argv[])
     return 1;
   }
 
-  return 0;
+  if (options.traceFile != "")
+    oms_exportTrace(options.traceFile.c_str());
+
+  return returnCode;
 }
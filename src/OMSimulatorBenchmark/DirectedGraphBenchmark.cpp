@@ -0,0 +1,237 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-CurrentYear, Open Source Modelica Consortium (OSMC),
+ * c/o Linköpings universitet, Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF GPL VERSION 3 LICENSE OR
+ * THIS OSMC PUBLIC LICENSE (OSMC-PL) VERSION 1.2.
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES
+ * RECIPIENT'S ACCEPTANCE OF THE OSMC PUBLIC LICENSE OR THE GPL VERSION 3,
+ * ACCORDING TO RECIPIENTS CHOICE.
+ *
+ * The OpenModelica software and the Open Source Modelica
+ * Consortium (OSMC) Public License (OSMC-PL) are obtained
+ * from OSMC, either from the above address,
+ * from the URLs: http://www.ida.liu.se/projects/OpenModelica or
+ * http://www.openmodelica.org, and in the OpenModelica distribution.
+ * GNU version 3 is obtained from: http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without
+ * even the implied warranty of  MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE, EXCEPT AS EXPRESSLY SET FORTH
+ * IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE CONDITIONS OF OSMC-PL.
+ *
+ * See the full OSMC Public License conditions for more details.
+ *
+ */
+
+/*
+ * Benchmark of the dependency graph: builds the graph of a large synthetic
+ * composite model and times getSortedConnections(). The sorted connections
+ * are also checked against a straightforward recursive implementation of
+ * Tarjan's algorithm on smaller random graphs.
+ *
+ * usage: DirectedGraphBenchmark [instances] [ports] [dependencies]
+ */
+
+#include "DirectedGraph.h"
+#include "Variable.h"
+#include "OMSimulator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+class BenchmarkVariable : public Variable
+{
+public:
+  BenchmarkVariable(const std::vector<std::string>* names, unsigned int index, const std::string* instanceName, bool input)
+    : Variable(names, index, instanceName, index, input ? fmi2_causality_enu_input : fmi2_causality_enu_output) {}
+};
+
+// synthetic FMU instance with the inputs u0..un-1 and the outputs y0..yn-1
+struct Instance
+{
+  std::string name;
+  std::vector<std::string> names;
+  std::vector<Variable> inputs;
+  std::vector<Variable> outputs;
+};
+
+static void createInstances(std::deque<Instance>& instances, int numInstances, int numPorts)
+{
+  for (int i = 0; i < numInstances; ++i)
+  {
+    instances.push_back(Instance());
+    Instance& instance = instances.back();
+    instance.name = "fmu" + std::to_string(i);
+    for (int k = 0; k < numPorts; ++k)
+      instance.names.push_back("u" + std::to_string(k));
+    for (int k = 0; k < numPorts; ++k)
+      instance.names.push_back("y" + std::to_string(k));
+    for (int k = 0; k < numPorts; ++k)
+      instance.inputs.push_back(BenchmarkVariable(&instance.names, k, &instance.name, true));
+    for (int k = 0; k < numPorts; ++k)
+      instance.outputs.push_back(BenchmarkVariable(&instance.names, numPorts + k, &instance.name, false));
+  }
+}
+
+// direct feedthrough within the instances and connections between them,
+// merged like in CompositeModel::instantiateFMU
+static void createGraph(DirectedGraph& graph, std::deque<Instance>& instances, int numDependencies, std::mt19937& rng)
+{
+  const int numInstances = static_cast<int>(instances.size());
+  const int numPorts = static_cast<int>(instances[0].inputs.size());
+  std::uniform_int_distribution<int> port(0, numPorts - 1);
+  std::uniform_int_distribution<int> other(0, numInstances - 1);
+
+  for (int i = 0; i < numInstances; ++i)
+  {
+    DirectedGraph fmuGraph;
+    for (int k = 0; k < numPorts; ++k)
+      fmuGraph.addVariable(instances[i].outputs[k]);
+    for (int k = 0; k < numPorts; ++k)
+      for (int d = 0; d < numDependencies; ++d)
+        fmuGraph.addEdge(instances[i].inputs[port(rng)], instances[i].outputs[k]);
+    graph.includeGraph(fmuGraph);
+  }
+
+  for (int i = 0; i < numInstances; ++i)
+    for (int k = 0; k < numPorts; ++k)
+      graph.addEdge(instances[other(rng)].outputs[port(rng)], instances[i].inputs[k]);
+}
+
+// reference: recursive Tarjan on the graph of edges, as used before
+static void strongconnect(int v, const std::vector< std::pair<int, int> >& edges, const std::vector< std::vector<int> >& G, int& index, std::vector<int>& d, std::vector<int>& low, std::vector<int>& S, std::vector<bool>& stacked, std::deque< std::vector<int> >& components)
+{
+  d[v] = low[v] = index++;
+  S.push_back(v);
+  stacked[v] = true;
+
+  const std::vector<int>& successors = G[edges[v].second];
+  for (size_t i = 0; i < successors.size(); ++i)
+  {
+    // first edge between the two nodes
+    int w = 0;
+    while (edges[w].first != edges[v].second || edges[w].second != successors[i])
+      w++;
+
+    if (d[w] == -1)
+    {
+      strongconnect(w, edges, G, index, d, low, S, stacked, components);
+      low[v] = std::min(low[v], low[w]);
+    }
+    else if (stacked[w])
+      low[v] = std::min(low[v], d[w]);
+  }
+
+  if (low[v] == d[v])
+  {
+    std::vector<int> SCC;
+    int w;
+    do
+    {
+      w = S.back();
+      S.pop_back();
+      stacked[w] = false;
+      SCC.push_back(w);
+    } while (w != v);
+    components.push_front(SCC);
+  }
+}
+
+static std::vector< std::vector< std::pair<int, int> > > referenceSortedConnections(const DirectedGraph& graph)
+{
+  const std::vector< std::pair<int, int> >& edges = graph.edges;
+  std::vector< std::vector<int> > G(graph.nodes.size());
+  for (size_t i = 0; i < edges.size(); ++i)
+    G[edges[i].first].push_back(edges[i].second);
+
+  std::vector<int> d(edges.size(), -1), low(edges.size()), S;
+  std::vector<bool> stacked(edges.size(), false);
+  std::deque< std::vector<int> > components;
+  int index = 0;
+  for (int v = 0; v < static_cast<int>(edges.size()); ++v)
+    if (d[v] == -1)
+      strongconnect(v, edges, G, index, d, low, S, stacked, components);
+
+  std::vector< std::vector< std::pair<int, int> > > sortedConnections;
+  for (size_t i = 0; i < components.size(); ++i)
+  {
+    std::vector< std::pair<int, int> > SCC;
+    for (size_t j = 0; j < components[i].size(); ++j)
+      if (graph.nodes[edges[components[i][j]].first].isOutput() && graph.nodes[edges[components[i][j]].second].isInput())
+        SCC.push_back(edges[components[i][j]]);
+    if (SCC.size() > 0)
+      sortedConnections.push_back(SCC);
+  }
+  return sortedConnections;
+}
+
+static double seconds(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[])
+{
+  const int numInstances = argc > 1 ? atoi(argv[1]) : 300;
+  const int numPorts = argc > 2 ? atoi(argv[2]) : 30;
+  const int numDependencies = argc > 3 ? atoi(argv[3]) : 12;
+  if (numInstances < 1 || numPorts < 1 || numDependencies < 1)
+  {
+    std::cerr << "usage: " << argv[0] << " [instances] [ports] [dependencies]" << std::endl;
+    return 1;
+  }
+
+  // the warnings about the algebraic loops of the random models only go to the log file
+  oms_logToStdStream(0);
+
+  // equivalence with the reference implementation
+  std::mt19937 rng(42);
+  for (int trial = 0; trial < 200; ++trial)
+  {
+    std::deque<Instance> instances;
+    createInstances(instances, 1 + trial % 10, 1 + trial % 4);
+    DirectedGraph graph;
+    createGraph(graph, instances, 1 + trial % 3, rng);
+    if (graph.getSortedConnections() != referenceSortedConnections(graph))
+    {
+      std::cerr << "getSortedConnections differs from the reference in trial " << trial << std::endl;
+      return 1;
+    }
+  }
+  std::cout << "getSortedConnections matches the reference implementation" << std::endl;
+
+  // large model
+  std::deque<Instance> instances;
+  createInstances(instances, numInstances, numPorts);
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  DirectedGraph graph;
+  createGraph(graph, instances, numDependencies, rng);
+  double tBuild = seconds(start);
+
+  start = std::chrono::steady_clock::now();
+  const std::vector< std::vector< std::pair<int, int> > >& connections = graph.getSortedConnections();
+  double tSort = seconds(start);
+
+  size_t numLoops = 0;
+  for (size_t i = 0; i < connections.size(); ++i)
+    if (connections[i].size() > 1)
+      numLoops++;
+
+  std::cout << graph.nodes.size() << " nodes, " << graph.edges.size() << " edges" << std::endl;
+  std::cout << "  build graph:          " << tBuild << "s" << std::endl;
+  std::cout << "  getSortedConnections: " << tSort << "s (" << connections.size() << " groups, " << numLoops << " algebraic loops)" << std::endl;
+  return 0;
+}
@@ -43,7 +43,7 @@ CSVWriter::CSVWriter(unsigned int bufferSize)
 
 CSVWriter::~CSVWriter()
 {
-  closeFile();
+  close();
 }
 
 bool CSVWriter::createFile(const std::string& filename, double startTime, double stopTime)
@@ -67,20 +67,32 @@ void CSVWriter::closeFile()
 {
   if (pFile)
   {
-    writeFile();
     fclose(pFile);
     pFile = NULL;
   }
 }
 
-void CSVWriter::writeFile()
+void CSVWriter::writeFile(const Buffer& buffer)
 {
-  for (int i = 0; i < nEmits; ++i)
+  for (int i = 0; i < buffer.nRows; ++i)
   {
-    fprintf(pFile, "%.12g", data_2[i * (signals.size() + 1) + 0]);
+    fprintf(pFile, "%.12g", buffer.data_2[i * (nReals + 1) + 0]);
 
-    for (int j = 1; j < signals.size() + 1; ++j)
-      fprintf(pFile, ", %.12g", data_2[i * (signals.size() + 1) + j]);
+    for (int j = 0; j < signals.size(); ++j)
+    {
+      switch (signals[j].type)
+      {
+      case SignalType_REAL:
+        fprintf(pFile, ", %.12g", buffer.data_2[i * (nReals + 1) + columns[j]]);
+        break;
+      case SignalType_INT:
+        fprintf(pFile, ", %d", buffer.data_3[i * nInts + columns[j]]);
+        break;
+      case SignalType_BOOL:
+        fprintf(pFile, ", %d", buffer.data_4[i * nBools + columns[j]]);
+        break;
+      }
+    }
 
     fprintf(pFile, "\n");
   }
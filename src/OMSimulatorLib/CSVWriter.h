@@ -47,7 +47,7 @@ public:
 protected:
   bool createFile(const std::string& filename, double startTime, double stopTime);
   void closeFile();
-  void writeFile();
+  void writeFile(const Buffer& buffer);
 
 private:
   FILE *pFile;
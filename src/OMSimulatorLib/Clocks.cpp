@@ -33,11 +33,10 @@
 #include "Clock.h"
 #include "Util.h"
 #include "Logging.h"
+#include "Timeline.h"
 
 #include <string>
 
-Clocks globalClocks(GLOBALCLOCK_MAX_INDEX);
-
 const char* GlobalClockNames[GLOBALCLOCK_MAX_INDEX] = {
   /* GLOBALCLOCK_IDLE */           "idle",
   /* GLOBALCLOCK_INSTANTIATION */  "instantiation",
@@ -47,9 +46,14 @@ const char* GlobalClockNames[GLOBALCLOCK_MAX_INDEX] = {
   /* GLOBALCLOCK_RESULTFILE */     "result file"
 };
 
-Clocks::Clocks(int numSubClocks)
-  : numSubClocks(numSubClocks)
+thread_local Clocks globalClocks(GLOBALCLOCK_MAX_INDEX, GlobalClockNames, "OMSimulator");
+
+Clocks::Clocks(int numSubClocks, const char** names, const std::string& owner)
+  : numSubClocks(numSubClocks),
+    names(names)
 {
+  this->owner = Timeline::getInstance().registerOwner(owner);
+
   clocks = new Clock[numSubClocks];
 
   for (int i = 0; i<numSubClocks; ++i)
@@ -69,6 +73,7 @@ Clocks::~Clocks()
 
 void Clocks::tic(int index)
 {
+  Timeline::getInstance().record('B', names[index], owner);
   int activeClock = activeClocks.top();
 
   if (activeClock == index)
@@ -84,6 +89,7 @@ void Clocks::tic(int index)
 
 void Clocks::toc(int index)
 {
+  Timeline::getInstance().record('E', names[index], owner);
   int activeClock = activeClocks.top();
 
   if (activeClock != index)
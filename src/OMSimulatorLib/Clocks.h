@@ -62,7 +62,7 @@ enum GlobalClockIndex_t
 class Clocks
 {
 public:
-  Clocks(int numSubClocks);
+  Clocks(int numSubClocks, const char** names, const std::string& owner);
   ~Clocks();
 
   void tic(int clock);
@@ -73,6 +73,8 @@ private:
   int numSubClocks;
   Clock *clocks;
   std::stack<int> activeClocks;
+  const char** names;
+  unsigned int owner; ///< owner id in the timeline
 
 private:
   // Stop the compiler generating methods of copy the object
@@ -80,7 +82,8 @@ private:
   Clocks& operator=(Clocks const& copy); // Not Implemented
 };
 
-extern Clocks globalClocks;
+// one set of global clocks per thread, so that models can be simulated concurrently
+extern thread_local Clocks globalClocks;
 extern const char* GlobalClockNames[GLOBALCLOCK_MAX_INDEX];
 
 #endif
@@ -39,6 +39,7 @@
 #include "ResultWriter.h"
 #include "CSVWriter.h"
 #include "MATWriter.h"
+#include "KinsolSolver.h"
 
 #include <fmilib.h>
 #include <JM/jm_portability.h>
@@ -52,8 +53,10 @@
 #include <cstdlib>
 #include <stdlib.h>
 #include <deque>
+#include <set>
 #include <regex>
 #include <algorithm>
+#include <cmath>
 
 #include <boost/filesystem.hpp>
 
@@ -62,7 +65,10 @@
 
 CompositeModel::CompositeModel()
   : fmuInstances(),
-    resultFile(NULL)
+    resultFile(NULL),
+    threadPool(NULL),
+    sensitivityFMU(NULL),
+    canRollback(false)
 {
   logTrace();
   modelState = oms_modelState_instantiated;
@@ -88,6 +94,11 @@ CompositeModel::~CompositeModel()
   std::unordered_map<std::string, FMUWrapper*>::iterator it;
   for (it=fmuInstances.begin(); it != fmuInstances.end(); it++)
     delete it->second;
+
+  if (threadPool)
+    delete threadPool;
+
+  freeAlgLoopSolvers();
 }
 
 void CompositeModel::instantiateFMU(const std::string& filename, const std::string& instanceName)
@@ -252,6 +263,209 @@ bool CompositeModel::getBoolean(const std::string& var)
   return fmuInstances[fmuInstance]->getBoolean(fmuVar);
 }
 
+/**
+ * Resolves the given variable once and returns a handle for the fast
+ * get/set functions below or -1 if the variable doesn't exist. The handles
+ * are valid as long as the model exists.
+ */
+int CompositeModel::getVariableHandle(const std::string& var)
+{
+  logTrace();
+  auto it = variableHandleIndex.find(var);
+  if (it != variableHandleIndex.end())
+    return it->second;
+
+  std::stringstream var_(var);
+  std::string fmuInstance;
+  std::string fmuVar;
+
+  std::getline(var_, fmuInstance, '.');
+  std::getline(var_, fmuVar);
+
+  if (fmuInstances.find(fmuInstance) == fmuInstances.end())
+  {
+    logError("CompositeModel::getVariableHandle: FMU instance \"" + fmuInstance + "\" doesn't exist in model");
+    return -1;
+  }
+
+  VariableHandle handle;
+  handle.name = var;
+  handle.fmu = fmuInstances[fmuInstance];
+  handle.variable = handle.fmu->getVariable(fmuVar);
+  if (!handle.variable)
+  {
+    logError("CompositeModel::getVariableHandle: FMU instance \"" + fmuInstance + "\" doesn't contain variable " + fmuVar);
+    return -1;
+  }
+
+  variableHandles.push_back(handle);
+  variableHandleIndex[var] = variableHandles.size() - 1;
+  return variableHandles.size() - 1;
+}
+
+oms_status_t CompositeModel::setRealByHandle(int handle, double value)
+{
+  if (handle < 0 || handle >= variableHandles.size())
+  {
+    logError("CompositeModel::setRealByHandle: invalid handle " + std::to_string(handle));
+    return oms_status_error;
+  }
+
+  VariableHandle& h = variableHandles[handle];
+  if (h.variable->isParameter())
+  {
+    if (!h.fmu->setRealParameter(*h.variable, value))
+      return oms_status_error;
+
+    // store the list of modified parameters
+    realParameterList[h.name] = value;
+  }
+  else if (!h.variable->isInput() || !h.fmu->setRealInput(*h.variable, value))
+  {
+    logError("CompositeModel::setRealByHandle: " + h.name + " is neither a real parameter nor a real input");
+    return oms_status_error;
+  }
+
+  return oms_status_ok;
+}
+
+oms_status_t CompositeModel::getRealByHandle(int handle, double* value)
+{
+  if (handle < 0 || handle >= variableHandles.size())
+  {
+    logError("CompositeModel::getRealByHandle: invalid handle " + std::to_string(handle));
+    return oms_status_error;
+  }
+
+  VariableHandle& h = variableHandles[handle];
+  if (!h.variable->isTypeReal())
+  {
+    logError("CompositeModel::getRealByHandle: " + h.name + " isn't a real variable");
+    return oms_status_error;
+  }
+
+  *value = h.fmu->getReal(*h.variable);
+  return oms_status_ok;
+}
+
+oms_status_t CompositeModel::setReals(const int* handles, int n, const double* values)
+{
+  oms_status_t status = oms_status_ok;
+  for (int i=0; i<n; ++i)
+    if (oms_status_ok != setRealByHandle(handles[i], values[i]))
+      status = oms_status_error;
+  return status;
+}
+
+oms_status_t CompositeModel::getReals(const int* handles, int n, double* values)
+{
+  oms_status_t status = oms_status_ok;
+  for (int i=0; i<n; ++i)
+    if (oms_status_ok != getRealByHandle(handles[i], &values[i]))
+      status = oms_status_error;
+  return status;
+}
+
+/*
+ * The sensitivity parameters have to belong to a single FMU ME that is
+ * simulated with CVODE. Sensitivities aren't propagated through connections,
+ * thus none of the inputs of that FMU may be connected. An empty list of
+ * handles switches the sensitivity analysis off.
+ */
+oms_status_t CompositeModel::setSensitivityParameters(const int* handles, int n)
+{
+  logTrace();
+
+  if (oms_modelState_instantiated != modelState)
+  {
+    logError("CompositeModel::setSensitivityParameters: Model is already in simulation mode.");
+    return oms_status_error;
+  }
+
+  FMUWrapper* fmu = NULL;
+  std::vector<fmi2_value_reference_t> parameters;
+  for (int i=0; i<n; ++i)
+  {
+    if (handles[i] < 0 || handles[i] >= variableHandles.size())
+    {
+      logError("CompositeModel::setSensitivityParameters: invalid handle " + std::to_string(handles[i]));
+      return oms_status_error;
+    }
+
+    VariableHandle& h = variableHandles[handles[i]];
+    if (!h.variable->isParameter() || !h.variable->isTypeReal())
+    {
+      logError("CompositeModel::setSensitivityParameters: " + h.name + " isn't a real parameter");
+      return oms_status_error;
+    }
+    if (fmu && fmu != h.fmu)
+    {
+      logError("CompositeModel::setSensitivityParameters: All parameters need to belong to the same FMU instance");
+      return oms_status_error;
+    }
+    fmu = h.fmu;
+    parameters.push_back(h.variable->getValueReference());
+  }
+
+  if (fmu)
+  {
+    const std::vector< std::vector< std::pair<int, int> > >& connections = outputsGraph.getSortedConnections();
+    for (int i=0; i<connections.size(); i++)
+      for (int j=0; j<connections[i].size(); j++)
+        if (outputsGraph.nodes[connections[i][j].second].getFMUInstanceName() == fmu->getFMUInstanceName())
+        {
+          logError("CompositeModel::setSensitivityParameters: Sensitivities aren't supported for FMU instance '" + fmu->getFMUInstanceName() + "' with connected inputs");
+          return oms_status_error;
+        }
+
+    if (!fmu->setSensitivityParameters(parameters))
+      return oms_status_error;
+  }
+
+  if (sensitivityFMU && sensitivityFMU != fmu)
+    sensitivityFMU->setSensitivityParameters(std::vector<fmi2_value_reference_t>());
+  sensitivityFMU = fmu;
+  return oms_status_ok;
+}
+
+oms_status_t CompositeModel::getRealSensitivities(const int* handles, int n, double* sensitivities)
+{
+  logTrace();
+
+  if (!sensitivityFMU)
+  {
+    logError("CompositeModel::getRealSensitivities: No sensitivity parameters are set.");
+    return oms_status_error;
+  }
+  if (oms_modelState_simulation != modelState)
+  {
+    logError("It is only allowed to call 'getRealSensitivities' while running a simulation.");
+    return oms_status_error;
+  }
+
+  std::vector<fmi2_value_reference_t> vr(n);
+  for (int i=0; i<n; ++i)
+  {
+    if (handles[i] < 0 || handles[i] >= variableHandles.size())
+    {
+      logError("CompositeModel::getRealSensitivities: invalid handle " + std::to_string(handles[i]));
+      return oms_status_error;
+    }
+
+    VariableHandle& h = variableHandles[handles[i]];
+    if (h.fmu != sensitivityFMU || !h.variable->isTypeReal())
+    {
+      logError("CompositeModel::getRealSensitivities: " + h.name + " isn't a real variable of FMU instance '" + sensitivityFMU->getFMUInstanceName() + "'");
+      return oms_status_error;
+    }
+    vr[i] = h.variable->getValueReference();
+  }
+
+  if (!sensitivityFMU->getRealSensitivities(vr.data(), n, sensitivities))
+    return oms_status_error;
+  return oms_status_ok;
+}
+
 void CompositeModel::addConnection(const std::string& from, const std::string& to)
 {
   logTrace();
@@ -329,12 +543,23 @@ void CompositeModel::exportXML(const char* filename)
   std::string stopTime = std::to_string(settings.GetStopTime());
   std::string tolerance = std::to_string(settings.GetTolerance());
   std::string communicationInterval = std::to_string(settings.GetCommunicationInterval());
+  std::string algLoopSolver = GetAlgLoopSolverString();
+  std::string masterAlgorithm = GetMasterAlgorithmString();
+  std::string minimalStepSize = toExactString(settings.GetMinimalStepSize());
+  std::string maximalStepSize = toExactString(settings.GetMaximalStepSize());
+  std::string couplingTolerance = toExactString(settings.GetCouplingTolerance());
 
   simulationparams.append_attribute("StartTime") = startTime.c_str();
   simulationparams.append_attribute("StopTime") = stopTime.c_str();
   simulationparams.append_attribute("tolerance") = tolerance.c_str();
   simulationparams.append_attribute("communicationInterval") = communicationInterval.c_str();
   simulationparams.append_attribute("variableFilter") = ".*";
+  simulationparams.append_attribute("algLoopSolver") = algLoopSolver.c_str();
+  simulationparams.append_attribute("masterAlgorithm") = masterAlgorithm.c_str();
+  simulationparams.append_attribute("adaptiveStepSize") = settings.GetAdaptiveStepSize() ? "true" : "false";
+  simulationparams.append_attribute("minimalStepSize") = minimalStepSize.c_str();
+  simulationparams.append_attribute("maximalStepSize") = maximalStepSize.c_str();
+  simulationparams.append_attribute("couplingTolerance") = couplingTolerance.c_str();
 
   // add list of FMUs
   std::unordered_map<std::string, FMUWrapper*>::iterator it;
@@ -349,6 +574,18 @@ void CompositeModel::exportXML(const char* filename)
     {
       std::string getsolver= it->second->GetSolverMethodString();
       submodel.append_attribute("solver") = getsolver.c_str();
+      std::string getlinearsolver= it->second->GetLinearSolverString();
+      submodel.append_attribute("linearSolver") = getlinearsolver.c_str();
+      for (auto& option: it->second->getSolverOptions())
+      {
+        std::string getoption = toExactString(option.second);
+        submodel.append_attribute(option.first.c_str()) = getoption.c_str();
+      }
+    }
+    if (it->second->hasCommunicationInterval())
+    {
+      std::string getinterval = toExactString(it->second->getCommunicationInterval());
+      submodel.append_attribute("communicationInterval") = getinterval.c_str();
     }
   }
 
@@ -477,6 +714,9 @@ void CompositeModel::importXML(const char* filename)
     std::string instancename;
     std::string filename;
     std::string solvername;
+    std::string linearsolvername;
+    double interval = 0.0;
+    std::map<std::string, double> solveroptions;
     for (pugi::xml_attribute_iterator ait = it->attributes_begin(); ait != it->attributes_end(); ++ait)
     {
       std::string value =ait->name();
@@ -492,6 +732,18 @@ void CompositeModel::importXML(const char* filename)
       {
         solvername = ait->value();
       }
+      if (value == "linearSolver")
+      {
+        linearsolvername = ait->value();
+      }
+      if (value == "communicationInterval")
+      {
+        interval = ait->as_double();
+      }
+      if (FMUWrapper::isSolverOption(value))
+      {
+        solveroptions[value] = ait->as_double();
+      }
     }
 
     instantiateFMU(filename, instancename);
@@ -499,6 +751,18 @@ void CompositeModel::importXML(const char* filename)
     {
       fmuInstances[instancename]->SetSolverMethod(solvername);
     }
+    if (linearsolvername != "")
+    {
+      fmuInstances[instancename]->SetLinearSolver(linearsolvername);
+    }
+    if (interval > 0.0)
+    {
+      fmuInstances[instancename]->setCommunicationInterval(interval);
+    }
+    for (auto& option: solveroptions)
+    {
+      fmuInstances[instancename]->setSolverOption(option.first, option.second);
+    }
 
     // read and set the parameter from the node instances
     for (pugi::xml_node modelparam = it->first_child(); modelparam; modelparam = modelparam.next_sibling())
@@ -531,6 +795,8 @@ void CompositeModel::importXML(const char* filename)
   }
 
   // read the simulation settings and set
+  double minimalStepSize = settings.GetMinimalStepSize();
+  double maximalStepSize = settings.GetMaximalStepSize();
   for (pugi::xml_attribute attr = SimulationParams.first_attribute(); attr; attr = attr.next_attribute())
   {
     std::string name = attr.name();
@@ -559,11 +825,111 @@ void CompositeModel::importXML(const char* filename)
     {
       setVariableFilter(".*", attr.value());
     }
+    else if (name == "algLoopSolver")
+    {
+      if (!value.empty())
+        SetAlgLoopSolver(value);
+    }
+    else if (name == "masterAlgorithm")
+    {
+      if (!value.empty())
+        SetMasterAlgorithm(value);
+    }
+    else if (name == "adaptiveStepSize")
+    {
+      if (!value.empty())
+        settings.SetAdaptiveStepSize(attr.as_bool());
+    }
+    else if (name == "minimalStepSize")
+    {
+      if (!value.empty())
+        minimalStepSize = std::strtod(attr.value(), NULL);
+    }
+    else if (name == "maximalStepSize")
+    {
+      if (!value.empty())
+        maximalStepSize = std::strtod(attr.value(), NULL);
+    }
+    else if (name == "couplingTolerance")
+    {
+      if (!value.empty())
+        settings.SetCouplingTolerance(std::strtod(attr.value(), NULL));
+    }
   }
 
+  // both bounds at once, independent of the order of the attributes
+  if (minimalStepSize != settings.GetMinimalStepSize() || maximalStepSize != settings.GetMaximalStepSize())
+    settings.SetStepSizeBounds(minimalStepSize, maximalStepSize);
+
   OMS_TOC(globalClocks, GLOBALCLOCK_INSTANTIATION);
 }
 
+CompositeModel* CompositeModel::clone()
+{
+  logTrace();
+
+  if (oms_modelState_instantiated != modelState)
+  {
+    logError("CompositeModel::clone: Model is already in simulation mode.");
+    return NULL;
+  }
+
+  CompositeModel* model = new CompositeModel();
+
+  // simulation settings; the clone doesn't write a result file
+  model->settings.SetStartTime(settings.GetStartTime());
+  model->settings.SetStopTime(settings.GetStopTime());
+  model->settings.SetTolerance(settings.GetTolerance());
+  model->settings.SetCommunicationInterval(settings.GetCommunicationInterval());
+  model->settings.SetNumProcs(settings.GetNumProcs());
+  model->settings.SetAlgLoopSolver(settings.GetAlgLoopSolver());
+  model->settings.SetMasterAlgorithm(settings.GetMasterAlgorithm());
+  model->settings.SetAdaptiveStepSize(settings.GetAdaptiveStepSize());
+  model->settings.SetStepSizeBounds(settings.GetMinimalStepSize(), settings.GetMaximalStepSize());
+  model->settings.SetCouplingTolerance(settings.GetCouplingTolerance());
+
+  // FMU instances
+  std::unordered_map<std::string, FMUWrapper*>::iterator it;
+  for (it=fmuInstances.begin(); it != fmuInstances.end(); it++)
+  {
+    model->instantiateFMU(it->second->getFMUPath(), it->first);
+    if (it->second->isFMUKindME())
+    {
+      model->SetSolverMethod(it->first, it->second->GetSolverMethodString());
+      model->SetLinearSolver(it->first, it->second->GetLinearSolverString());
+    }
+    if (it->second->hasCommunicationInterval())
+      model->setInstanceCommunicationInterval(it->first, it->second->getCommunicationInterval());
+    for (auto& option: it->second->getSolverOptions())
+      model->setSolverOption(it->first, option.first, option.second);
+  }
+
+  // connections
+  const std::vector< std::vector< std::pair<int, int> > >& connections = outputsGraph.getSortedConnections();
+  for (int i=0; i<connections.size(); i++)
+  {
+    for (int j=0; j<connections[i].size(); j++)
+    {
+      const Variable& output = outputsGraph.nodes[connections[i][j].first];
+      const Variable& input = outputsGraph.nodes[connections[i][j].second];
+      model->addConnection(output.getFMUInstanceName() + "." + output.getName(), input.getFMUInstanceName() + "." + input.getName());
+    }
+  }
+
+  // modified parameters
+  for (auto& param: realParameterList)
+    model->setReal(param.first, param.second);
+  for (auto& param: integerParameterList)
+    model->setInteger(param.first, param.second);
+  for (auto& param: booleanParameterList)
+    model->setBoolean(param.first, param.second);
+
+  model->interfaceNames = interfaceNames;
+  model->interfaceVariables = interfaceVariables;
+
+  return model;
+}
+
 Variable* CompositeModel::getVariable(const std::string& name)
 {
   std::stringstream name_(name);
@@ -593,12 +959,18 @@ void CompositeModel::describe()
   {
     std::cout << it->first << std::endl;
     if (it->second->isFMUKindME())
-      std::cout << "  - " << it->second->getFMUKind() << " (solver: " << it->second->GetSolverMethodString() << ")" << std::endl;
+    {
+      std::cout << "  - " << it->second->getFMUKind() << " (solver: " << it->second->GetSolverMethodString() << ", linear solver: " << it->second->GetLinearSolverString() << ")" << std::endl;
+      for (auto& option: it->second->getSolverOptions())
+        std::cout << "  - solver option " << option.first << ": " << option.second << std::endl;
+    }
     else
       std::cout << "  - " << it->second->getFMUKind() << std::endl;
     std::cout << "  - path: " << it->second->getFMUPath() << std::endl;
     std::cout << "  - GUID: " << it->second->getGUID() << std::endl;
     std::cout << "  - tool: " << it->second->getGenerationTool() << std::endl;
+    if (it->second->hasCommunicationInterval())
+      std::cout << "  - communication interval: " << it->second->getCommunicationInterval() << std::endl;
 
     std::cout << "  - input interface:" << std::endl;
     std::vector<Variable>& allVariables = it->second->getAllVariables();
@@ -622,6 +994,8 @@ void CompositeModel::describe()
   std::cout << "  - stop time: " << settings.GetStopTime() << std::endl;
   std::cout << "  - tolerance: " << settings.GetTolerance() << std::endl;
   std::cout << "  - communication interval: " << settings.GetCommunicationInterval() << std::endl;
+  std::cout << "  - algebraic loop solver: " << GetAlgLoopSolverString() << std::endl;
+  std::cout << "  - master algorithm: " << GetMasterAlgorithmString() << std::endl;
   std::cout << "  - result file: " << (settings.GetResultFile() ? settings.GetResultFile() : "<no result file>") << std::endl;
   //std::cout << "  - temp directory: " << settings.GetTempDirectory() << std::endl;
 
@@ -696,11 +1070,37 @@ void CompositeModel::describe()
     }
   }
 
+  std::cout << "\n## Stepping order" << std::endl;
+  std::vector< std::vector<std::string> > order = getInstanceOrder();
+  for(int i=0; i<order.size(); i++)
+  {
+    if (order[i].size() == 1)
+      std::cout << order[i][0] << std::endl;
+    else
+    {
+      // cycle of instances
+      std::cout << "{";
+      for(int j=0; j<order[i].size(); j++)
+        std::cout << (j > 0 ? "; " : "") << order[i][j];
+      std::cout << "}" << std::endl;
+    }
+  }
+
   std::cout << std::endl;
 }
 
-void CompositeModel::solveAlgLoop(DirectedGraph& graph, const std::vector< std::pair<int, int> >& SCC)
+oms_status_t CompositeModel::solveAlgLoop(DirectedGraph& graph, int idx)
 {
+  const std::vector< std::pair<int, int> >& SCC = graph.getSortedConnections()[idx];
+
+  if (Settings::KINSOL == settings.GetAlgLoopSolver())
+  {
+    KinsolSolver*& solver = algLoopSolvers[std::make_pair(&graph, idx)];
+    if (!solver)
+      solver = new KinsolSolver(graph, SCC, fmuInstances, settings.GetTolerance());
+    return solver->solve();
+  }
+
   const int size = SCC.size();
   const double tolerance = settings.GetTolerance();
   const int maxIterations = 100;
@@ -743,37 +1143,41 @@ void CompositeModel::solveAlgLoop(DirectedGraph& graph, const std::vector< std::
   delete[] res;
 
   if (it >= maxIterations)
-    logFatal("CompositeModel::solveAlgLoop: max. number of iterations (" + std::to_string(maxIterations) + ") exceeded");
+  {
+    logError("CompositeModel::solveAlgLoop: max. number of iterations (" + std::to_string(maxIterations) + ") exceeded");
+    return oms_status_error;
+  }
+
+  return oms_status_ok;
 }
 
-void CompositeModel::updateInputs(DirectedGraph& graph)
+void CompositeModel::freeAlgLoopSolvers()
+{
+  for (auto it=algLoopSolvers.begin(); it != algLoopSolvers.end(); it++)
+    delete it->second;
+  algLoopSolvers.clear();
+}
+
+oms_status_t CompositeModel::updateInputs(DirectedGraph& graph, ExchangePlan& plan)
 {
   OMS_TIC(globalClocks, GLOBALCLOCK_COMMUNICATION);
 
-  const std::vector< std::vector< std::pair<int, int> > >& sortedConnections = graph.getSortedConnections();
+  std::vector<ExchangePlan::Phase>& phases = plan.getPhases();
 
   // input = output
-  for(int i=0; i<sortedConnections.size(); i++)
+  for(int i=0; i<phases.size(); i++)
   {
-    if (sortedConnections[i].size() == 1)
+    if (phases[i].algLoop < 0)
+      plan.exchange(phases[i]);
+    else if (oms_status_ok != solveAlgLoop(graph, phases[i].algLoop))
     {
-      int output = sortedConnections[i][0].first;
-      int input = sortedConnections[i][0].second;
-      const std::string& outputFMU = graph.nodes[output].getFMUInstanceName();
-      //std::string& outputVar = graph.nodes[output].getName();
-      const std::string& inputFMU = graph.nodes[input].getFMUInstanceName();
-      //std::string& inputVar = graph.nodes[input].getName();
-      double value = fmuInstances[outputFMU]->getReal(graph.nodes[output]);
-      fmuInstances[inputFMU]->setRealInput(graph.nodes[input], value);
-      //std::cout << inputFMU << "." << inputVar << " = " << outputFMU << "." << outputVar << std::endl;
-    }
-    else
-    {
-      solveAlgLoop(graph, sortedConnections[i]);
+      OMS_TOC(globalClocks, GLOBALCLOCK_COMMUNICATION);
+      return oms_status_error;
     }
   }
 
   OMS_TOC(globalClocks, GLOBALCLOCK_COMMUNICATION);
+  return oms_status_ok;
 }
 
 oms_status_t CompositeModel::simulate()
@@ -791,6 +1195,86 @@ oms_status_t CompositeModel::simulate()
   return stepUntil(tend);
 }
 
+/**
+ * Steps all instances that reach their next communication point at stopTime.
+ *
+ * An instance with a longer communication interval than the model is only
+ * stepped once the master reaches its next communication point. In between,
+ * its outputs stay at the last communication point and its inputs are held.
+ * If synchronize is set, all instances are stepped to stopTime.
+ */
+void CompositeModel::doStep(double stopTime, bool synchronize)
+{
+  const bool gaussSeidel = Settings::GAUSS_SEIDEL == settings.GetMasterAlgorithm();
+  std::vector<FMUWrapper*> instances;
+
+  if (gaussSeidel)
+    instances = gaussSeidelOrder;
+  else
+    for (auto it=fmuInstances.begin(); it != fmuInstances.end(); it++)
+      instances.push_back(it->second);
+
+  for (int i=0; i<instances.size(); )
+  {
+    FMUWrapper* fmu = instances[i];
+    bool due = synchronize ||
+               fmu->getTime() + fmu->getCommunicationInterval() <= stopTime + 1e-9*communicationInterval;
+    fmu->setHoldInputs(!due);
+    if (due)
+      i++;
+    else
+      instances.erase(instances.begin() + i);
+  }
+
+  // Gauss-Seidel: each instance gets the fresh outputs of all instances
+  // that were stepped before it in dependency order
+  if (gaussSeidel)
+  {
+    for (int i=0; i<instances.size(); i++)
+    {
+      updateInputs(instances[i]);
+      instances[i]->doStep(stopTime);
+    }
+    return;
+  }
+
+  if (!threadPool)
+  {
+    for (int i=0; i<instances.size(); i++)
+      instances[i]->doStep(stopTime);
+    return;
+  }
+
+  // All instances are independent within one communication interval
+  // (Jacobi scheme), hence they can be stepped concurrently. The pool is
+  // joined before the caller exchanges any data between them.
+  for (int i=0; i<instances.size(); i++)
+  {
+    FMUWrapper* fmu = instances[i];
+    threadPool->push([fmu, stopTime] {fmu->doStep(stopTime);});
+  }
+  threadPool->wait();
+}
+
+void CompositeModel::updateInputs(FMUWrapper* fmu)
+{
+  OMS_TIC(globalClocks, GLOBALCLOCK_COMMUNICATION);
+
+  std::vector<Connection>& connections = gaussSeidelInputs[fmu];
+  for (int i=0; i<connections.size(); i++)
+  {
+    const Connection& c = connections[i];
+    if (c.input->isTypeReal())
+      fmu->setRealInput(*c.input, c.outputFMU->getReal(*c.output));
+    else if (c.input->isTypeInteger())
+      fmu->setIntegerInput(*c.input, c.outputFMU->getInteger(*c.output));
+    else if (c.input->isTypeBoolean())
+      fmu->setBooleanInput(*c.input, c.outputFMU->getBoolean(*c.output));
+  }
+
+  OMS_TOC(globalClocks, GLOBALCLOCK_COMMUNICATION);
+}
+
 void CompositeModel::emit()
 {
   if (!resultFile)
@@ -807,6 +1291,70 @@ void CompositeModel::emit()
   OMS_TOC(globalClocks, GLOBALCLOCK_RESULTFILE);
 }
 
+/**
+ * Takes one macro step of adaptive size that doesn't go beyond tmax.
+ *
+ * The inputs are held constant during a macro step, hence the coupling error
+ * is estimated as the deviation of the exchanged outputs at the end of the
+ * step from their constant extrapolation. The step size is then scaled
+ * within the bounds of the settings. A rejected step is repeated with a
+ * smaller step size from a snapshot if all FMU instances can get and set
+ * their state; otherwise it is accepted and only the next step is reduced.
+ * Each accepted step emits one point to the result file.
+ */
+oms_status_t CompositeModel::doAdaptiveStep(double tmax)
+{
+  const double hmin = settings.GetMinimalStepSize();
+  const double hmax = settings.GetMaximalStepSize();
+  const double tol = settings.GetCouplingTolerance();
+  const double safety = 0.9;
+  const double facmin = 0.2;
+  const double facmax = 5.0;
+
+  if (couplingValues.empty())
+    outputsPlan.getOutputs(couplingValues);
+
+  std::vector<double> values;
+  while (true)
+  {
+    double h = std::min(std::max(communicationInterval, hmin), hmax);
+    double tnext = tcur + h;
+    if (tnext > tmax - hmin)
+      tnext = tmax;
+
+    Snapshot* snapshot = canRollback ? saveSnapshot() : NULL;
+    doStep(tnext, true);
+    tcur = tnext;
+
+    outputsPlan.getOutputs(values);
+    double err = 0.0;
+    for (size_t i = 0; i < values.size(); ++i)
+      err = std::max(err, std::fabs(values[i] - couplingValues[i]) / (tol * (1.0 + std::fabs(couplingValues[i]))));
+
+    // ZOH coupling: the error is of first order in h
+    double fac = err > 0.0 ? safety / err : facmax;
+    communicationInterval = std::min(std::max(h * std::min(std::max(fac, facmin), facmax), hmin), hmax);
+
+    if (err > 1.0 && h > hmin && snapshot)
+    {
+      oms_status_t status = restoreSnapshot(snapshot);
+      logDebug("CompositeModel::doAdaptiveStep: rejected step at t=" + std::to_string(tcur) + " with h=" + std::to_string(h));
+      freeSnapshot(snapshot);
+      if (oms_status_ok != status)
+        return oms_status_error;
+      continue;
+    }
+    freeSnapshot(snapshot);
+
+    // input = output
+    if (oms_status_ok != updateInputs(outputsGraph, outputsPlan))
+      return oms_status_error;
+    outputsPlan.getOutputs(couplingValues);
+    emit();
+    return oms_status_ok;
+  }
+}
+
 oms_status_t CompositeModel::doSteps(const int numberOfSteps)
 {
   logTrace();
@@ -817,17 +1365,24 @@ oms_status_t CompositeModel::doSteps(const int numberOfSteps)
     return oms_status_error;
   }
 
+  if (settings.GetAdaptiveStepSize())
+  {
+    for(int step=0; step<numberOfSteps && tcur < settings.GetStopTime(); step++)
+      if (oms_status_ok != doAdaptiveStep(settings.GetStopTime()))
+        return oms_status_error;
+    return oms_status_ok;
+  }
+
   for(int step=0; step<numberOfSteps; step++)
   {
     // do_step
-    std::unordered_map<std::string, FMUWrapper*>::iterator it;
-    for (it=fmuInstances.begin(); it != fmuInstances.end(); it++)
-      it->second->doStep(tcur+communicationInterval);
+    doStep(tcur+communicationInterval, false);
     tcur += communicationInterval;
     emit();
 
     // input = output
-    updateInputs(outputsGraph);
+    if (oms_status_ok != updateInputs(outputsGraph, outputsPlan))
+      return oms_status_error;
     emit();
   }
 
@@ -844,6 +1399,14 @@ oms_status_t CompositeModel::stepUntil(const double timeValue)
     return oms_status_error;
   }
 
+  if (settings.GetAdaptiveStepSize())
+  {
+    while(tcur < timeValue)
+      if (oms_status_ok != doAdaptiveStep(timeValue))
+        return oms_status_error;
+    return oms_status_ok;
+  }
+
   while(tcur < timeValue)
   {
     tcur += communicationInterval;
@@ -851,20 +1414,19 @@ oms_status_t CompositeModel::stepUntil(const double timeValue)
       tcur = timeValue;
 
     // do_step
-    std::unordered_map<std::string, FMUWrapper*>::iterator it;
-    for (it=fmuInstances.begin(); it != fmuInstances.end(); it++)
-      it->second->doStep(tcur);
+    doStep(tcur, tcur == timeValue);
     emit();
 
     // input = output
-    updateInputs(outputsGraph);
+    if (oms_status_ok != updateInputs(outputsGraph, outputsPlan))
+      return oms_status_error;
     emit();
   }
 
   return oms_status_ok;
 }
 
-void CompositeModel::initialize()
+oms_status_t CompositeModel::initialize()
 {
   logTrace();
 
@@ -877,6 +1439,78 @@ void CompositeModel::initialize()
 
   tcur = settings.GetStartTime();
   communicationInterval = settings.GetCommunicationInterval();
+  couplingValues.clear();
+  freeAlgLoopSolvers();
+
+  // the master steps with the shortest communication interval
+  for (auto it = fmuInstances.begin(); it != fmuInstances.end(); ++it)
+  {
+    it->second->setHoldInputs(false);
+    if (it->second->hasCommunicationInterval())
+    {
+      if (settings.GetAdaptiveStepSize())
+        logWarning("CompositeModel::initialize: The communication interval of FMU instance \"" + it->first + "\" is ignored with an adaptive step size");
+      else
+        communicationInterval = std::min(communicationInterval, it->second->getCommunicationInterval());
+    }
+  }
+
+  // instances are only stepped at communication points of the master
+  if (!settings.GetAdaptiveStepSize())
+  {
+    for (auto it = fmuInstances.begin(); it != fmuInstances.end(); ++it)
+    {
+      double ratio = it->second->getCommunicationInterval() / communicationInterval;
+      if (std::fabs(ratio - std::round(ratio)) > 1e-6 * ratio)
+        logWarning("CompositeModel::initialize: The communication interval " + std::to_string(it->second->getCommunicationInterval()) + " of FMU instance \"" + it->first + "\" isn't a multiple of the master's interval " + std::to_string(communicationInterval) + " and is rounded up to " + std::to_string(std::ceil(ratio) * communicationInterval));
+    }
+  }
+
+  canRollback = false;
+  if (settings.GetAdaptiveStepSize())
+  {
+    canRollback = true;
+    for (auto it = fmuInstances.begin(); it != fmuInstances.end(); ++it)
+      canRollback = canRollback && it->second->canGetAndSetState();
+    if (!canRollback)
+      logWarning("CompositeModel::initialize: Not all FMU instances can get and set their state; rejected macro steps can't be repeated");
+  }
+
+  if (threadPool)
+  {
+    delete threadPool;
+    threadPool = NULL;
+  }
+  if (settings.GetNumProcs() > 1 && fmuInstances.size() > 1)
+  {
+    logInfo("Using " + std::to_string(settings.GetNumProcs()) + " threads for stepping the FMU instances");
+    threadPool = new ThreadPool(std::min(settings.GetNumProcs(), (unsigned int)fmuInstances.size()));
+  }
+
+  // precompute the data exchange between the FMU instances
+  outputsPlan.build(outputsGraph, fmuInstances);
+  initialUnknownsPlan.build(initialUnknownsGraph, fmuInstances);
+
+  gaussSeidelOrder.clear();
+  gaussSeidelInputs.clear();
+  if (Settings::GAUSS_SEIDEL == settings.GetMasterAlgorithm())
+  {
+    std::vector< std::vector<std::string> > order = getInstanceOrder();
+    for (int i=0; i<order.size(); i++)
+      for (int j=0; j<order[i].size(); j++)
+        gaussSeidelOrder.push_back(fmuInstances[order[i][j]]);
+
+    for (int i=0; i<outputsGraph.edges.size(); i++)
+    {
+      const Variable& output = outputsGraph.nodes[outputsGraph.edges[i].first];
+      const Variable& input = outputsGraph.nodes[outputsGraph.edges[i].second];
+      if (output.isOutput() && input.isInput())
+      {
+        Connection c = {fmuInstances[output.getFMUInstanceName()], &output, &input};
+        gaussSeidelInputs[fmuInstances[input.getFMUInstanceName()]].push_back(c);
+      }
+    }
+  }
 
   // Enter initialization
   modelState = oms_modelState_initialization;
@@ -884,7 +1518,9 @@ void CompositeModel::initialize()
   for (it=fmuInstances.begin(); it != fmuInstances.end(); it++)
     it->second->enterInitialization(tcur);
 
-  updateInputs(initialUnknownsGraph);
+  oms_status_t status = updateInputs(initialUnknownsGraph, initialUnknownsPlan);
+  if (oms_status_ok != status)
+    logError("CompositeModel::initialize: initialization of the composite model failed");
 
   // Exit initialization
   for (it=fmuInstances.begin(); it != fmuInstances.end(); it++)
@@ -902,12 +1538,15 @@ void CompositeModel::initialize()
     std::string extension = boost::filesystem::extension(settings.GetResultFile());
 
     if (".csv" == extension)
-      resultFile = new CSVWriter(1);
+      resultFile = new CSVWriter(settings.GetAsyncResultFile() ? 1024 : 1);
     else if (".mat" == extension)
       resultFile = new MATWriter(1024);
     else
       logWarning("Unknown result file type: " + extension);
 
+    if (resultFile && settings.GetAsyncResultFile())
+      resultFile->setAsync(2);
+
     if (resultFile)
     {
       logInfo("Result file: " + std::string(settings.GetResultFile()));
@@ -930,6 +1569,7 @@ void CompositeModel::initialize()
 
   OMS_TOC(globalClocks, GLOBALCLOCK_INITIALIZATION);
   OMS_TIC(globalClocks, GLOBALCLOCK_SIMULATION);
+  return status;
 }
 
 void CompositeModel::terminate()
@@ -954,6 +1594,14 @@ void CompositeModel::terminate()
     resultFile = NULL;
   }
 
+  if (threadPool)
+  {
+    delete threadPool;
+    threadPool = NULL;
+  }
+
+  freeAlgLoopSolvers();
+
   modelState = oms_modelState_instantiated;
 
   OMS_TOC(globalClocks, GLOBALCLOCK_SIMULATION);
@@ -994,6 +1642,176 @@ oms_status_t CompositeModel::getCurrentTime(double *time)
   return oms_status_ok;
 }
 
+CompositeModel::Snapshot* CompositeModel::saveSnapshot()
+{
+  logTrace();
+
+  if (oms_modelState_simulation != modelState)
+  {
+    logError("It is only allowed to call 'saveSnapshot' while running a simulation.");
+    return NULL;
+  }
+
+  Snapshot* snapshot = new Snapshot();
+  snapshot->tcur = tcur;
+  for (auto it = fmuInstances.begin(); it != fmuInstances.end(); ++it)
+  {
+    FMUWrapper::State* state = it->second->saveState();
+    if (!state)
+    {
+      freeSnapshot(snapshot);
+      return NULL;
+    }
+    snapshot->states[it->first] = state;
+  }
+  return snapshot;
+}
+
+/**
+ * Rolls all FMU instances back to the given snapshot. The result file isn't
+ * rewound, i.e. the emitted points after the snapshot remain in the file.
+ */
+oms_status_t CompositeModel::restoreSnapshot(const Snapshot* snapshot)
+{
+  logTrace();
+
+  if (oms_modelState_simulation != modelState)
+  {
+    logError("It is only allowed to call 'restoreSnapshot' while running a simulation.");
+    return oms_status_error;
+  }
+
+  if (snapshot->states.size() != fmuInstances.size())
+  {
+    logError("CompositeModel::restoreSnapshot: Snapshot doesn't match the model");
+    return oms_status_error;
+  }
+
+  for (auto it = snapshot->states.begin(); it != snapshot->states.end(); ++it)
+  {
+    if (fmuInstances.find(it->first) == fmuInstances.end())
+    {
+      logError("CompositeModel::restoreSnapshot: FMU instance \"" + it->first + "\" doesn't exist in model");
+      return oms_status_error;
+    }
+  }
+
+  for (auto it = snapshot->states.begin(); it != snapshot->states.end(); ++it)
+    if (!fmuInstances[it->first]->restoreState(it->second))
+      return oms_status_error;
+
+  tcur = snapshot->tcur;
+  return oms_status_ok;
+}
+
+void CompositeModel::freeSnapshot(Snapshot* snapshot)
+{
+  logTrace();
+
+  if (!snapshot)
+    return;
+
+  for (auto it = snapshot->states.begin(); it != snapshot->states.end(); ++it)
+  {
+    auto fmu = fmuInstances.find(it->first);
+    if (fmu != fmuInstances.end())
+      fmu->second->freeState(it->second);
+    else
+      logWarning("CompositeModel::freeSnapshot: FMU instance \"" + it->first + "\" doesn't exist in model");
+  }
+  delete snapshot;
+}
+
+static const char snapshotMagic[8] = {'O', 'M', 'S', 'S', 'N', 'A', 'P', '1'};
+
+oms_status_t CompositeModel::writeSnapshot(const Snapshot* snapshot, const std::string& filename)
+{
+  logTrace();
+
+  std::ofstream stream(filename, std::ios::binary);
+  if (!stream.is_open())
+  {
+    logError("CompositeModel::writeSnapshot: Couldn't open file \"" + filename + "\" for writing");
+    return oms_status_error;
+  }
+
+  stream.write(snapshotMagic, sizeof(snapshotMagic));
+  writeBinary(stream, snapshot->tcur);
+  writeBinary(stream, (uint64_t)snapshot->states.size());
+  for (auto it = snapshot->states.begin(); it != snapshot->states.end(); ++it)
+  {
+    auto fmu = fmuInstances.find(it->first);
+    if (fmu == fmuInstances.end())
+    {
+      logError("CompositeModel::writeSnapshot: FMU instance \"" + it->first + "\" doesn't exist in model");
+      return oms_status_error;
+    }
+
+    writeBinary(stream, std::vector<char>(it->first.begin(), it->first.end()));
+    if (!fmu->second->writeState(it->second, stream))
+      return oms_status_error;
+  }
+
+  if (!stream)
+  {
+    logError("CompositeModel::writeSnapshot: Failed to write file \"" + filename + "\"");
+    return oms_status_error;
+  }
+  return oms_status_ok;
+}
+
+CompositeModel::Snapshot* CompositeModel::readSnapshot(const std::string& filename)
+{
+  logTrace();
+
+  std::ifstream stream(filename, std::ios::binary);
+  if (!stream.is_open())
+  {
+    logError("CompositeModel::readSnapshot: Couldn't open file \"" + filename + "\" for reading");
+    return NULL;
+  }
+
+  char magic[sizeof(snapshotMagic)];
+  uint64_t n = 0;
+  Snapshot* snapshot = new Snapshot();
+  if (!stream.read(magic, sizeof(magic)) || memcmp(magic, snapshotMagic, sizeof(magic)) != 0 ||
+      !readBinary(stream, snapshot->tcur) || !readBinary(stream, n))
+  {
+    logError("CompositeModel::readSnapshot: \"" + filename + "\" isn't a snapshot file");
+    delete snapshot;
+    return NULL;
+  }
+
+  for (uint64_t i = 0; i < n; ++i)
+  {
+    std::vector<char> name;
+    if (!readBinary(stream, name))
+    {
+      logError("CompositeModel::readSnapshot: Corrupted snapshot file \"" + filename + "\"");
+      freeSnapshot(snapshot);
+      return NULL;
+    }
+
+    std::string instanceName(name.begin(), name.end());
+    auto fmu = fmuInstances.find(instanceName);
+    if (fmu == fmuInstances.end())
+    {
+      logError("CompositeModel::readSnapshot: FMU instance \"" + instanceName + "\" doesn't exist in model");
+      freeSnapshot(snapshot);
+      return NULL;
+    }
+
+    FMUWrapper::State* state = fmu->second->readState(stream);
+    if (!state)
+    {
+      freeSnapshot(snapshot);
+      return NULL;
+    }
+    snapshot->states[instanceName] = state;
+  }
+  return snapshot;
+}
+
 void CompositeModel::SetSolverMethod(std::string instanceName, std::string method)
 {
   if (fmuInstances.find(instanceName) == fmuInstances.end())
@@ -1005,6 +1823,232 @@ void CompositeModel::SetSolverMethod(std::string instanceName, std::string metho
   fmuInstances[instanceName]->SetSolverMethod(method);
 }
 
+void CompositeModel::SetLinearSolver(const std::string& instanceName, const std::string& solver)
+{
+  if (fmuInstances.find(instanceName) == fmuInstances.end())
+  {
+    logError("CompositeModel::SetLinearSolver: FMU instance \"" + instanceName + "\" doesn't exist in model");
+    return;
+  }
+
+  fmuInstances[instanceName]->SetLinearSolver(solver);
+}
+
+oms_status_t CompositeModel::setInstanceCommunicationInterval(const std::string& instanceName, double communicationInterval)
+{
+  logTrace();
+
+  if (oms_modelState_instantiated != modelState)
+  {
+    logError("CompositeModel::setInstanceCommunicationInterval: Model is already in simulation mode.");
+    return oms_status_error;
+  }
+
+  if (fmuInstances.find(instanceName) == fmuInstances.end())
+  {
+    logError("CompositeModel::setInstanceCommunicationInterval: FMU instance \"" + instanceName + "\" doesn't exist in model");
+    return oms_status_error;
+  }
+
+  if (communicationInterval < 0.0)
+  {
+    logError("CompositeModel::setInstanceCommunicationInterval: invalid communication interval " + std::to_string(communicationInterval));
+    return oms_status_error;
+  }
+
+  fmuInstances[instanceName]->setCommunicationInterval(communicationInterval);
+  return oms_status_ok;
+}
+
+oms_status_t CompositeModel::setSolverOption(const std::string& instanceName, const std::string& option, double value)
+{
+  logTrace();
+
+  if (oms_modelState_instantiated != modelState)
+  {
+    logError("CompositeModel::setSolverOption: Model is already in simulation mode.");
+    return oms_status_error;
+  }
+
+  if (fmuInstances.find(instanceName) == fmuInstances.end())
+  {
+    logError("CompositeModel::setSolverOption: FMU instance \"" + instanceName + "\" doesn't exist in model");
+    return oms_status_error;
+  }
+
+  if (!fmuInstances[instanceName]->setSolverOption(option, value))
+    return oms_status_error;
+  return oms_status_ok;
+}
+
+oms_status_t CompositeModel::getSolverStatistics(const std::string& instanceName, oms_solver_statistics_t* statistics)
+{
+  logTrace();
+
+  if (fmuInstances.find(instanceName) == fmuInstances.end())
+  {
+    logError("CompositeModel::getSolverStatistics: FMU instance \"" + instanceName + "\" doesn't exist in model");
+    return oms_status_error;
+  }
+
+  fmuInstances[instanceName]->getSolverStatistics(statistics);
+  return oms_status_ok;
+}
+
+void CompositeModel::SetMasterAlgorithm(const std::string& algorithm)
+{
+  if (algorithm == "jacobi")
+    settings.SetMasterAlgorithm(Settings::JACOBI);
+  else if (algorithm == "gaussseidel")
+    settings.SetMasterAlgorithm(Settings::GAUSS_SEIDEL);
+  else
+    logError("CompositeModel::SetMasterAlgorithm: Unknown master algorithm '" + algorithm + "'");
+}
+
+std::string CompositeModel::GetMasterAlgorithmString() const
+{
+  switch (settings.GetMasterAlgorithm())
+  {
+  case Settings::JACOBI:
+    return std::string("jacobi");
+  case Settings::GAUSS_SEIDEL:
+    return std::string("gaussseidel");
+  default:
+    logError("CompositeModel::GetMasterAlgorithmString: Unknown master algorithm " + std::to_string(settings.GetMasterAlgorithm()));
+    return std::string("unknown");
+  }
+}
+
+/**
+ * Orders the FMU instances by the connections of the outputs graph.
+ *
+ * Each group is a strongly connected component of the condensed FMU-level
+ * graph. The groups are sorted topologically and the instances within a
+ * group by name, which makes the order deterministic.
+ */
+std::vector< std::vector<std::string> > CompositeModel::getInstanceOrder()
+{
+  std::vector<std::string> names;
+  for (auto it=fmuInstances.begin(); it != fmuInstances.end(); it++)
+    names.push_back(it->first);
+  std::sort(names.begin(), names.end());
+
+  const int n = names.size();
+  std::unordered_map<std::string, int> index;
+  for (int i=0; i<n; i++)
+    index[names[i]] = i;
+
+  // condensed graph: an edge for each pair of connected instances
+  std::vector< std::vector<int> > successors(n);
+  for (int i=0; i<outputsGraph.edges.size(); i++)
+  {
+    const Variable& output = outputsGraph.nodes[outputsGraph.edges[i].first];
+    const Variable& input = outputsGraph.nodes[outputsGraph.edges[i].second];
+    if (!output.isOutput() || !input.isInput())
+      continue;
+    int from = index[output.getFMUInstanceName()];
+    int to = index[input.getFMUInstanceName()];
+    if (from != to && std::find(successors[from].begin(), successors[from].end(), to) == successors[from].end())
+      successors[from].push_back(to);
+  }
+
+  // reachability; the number of instances is small
+  std::vector< std::vector<bool> > reachable(n, std::vector<bool>(n, false));
+  for (int i=0; i<n; i++)
+  {
+    std::vector<int> stack(1, i);
+    while (!stack.empty())
+    {
+      int v = stack.back();
+      stack.pop_back();
+      for (int j=0; j<successors[v].size(); j++)
+      {
+        int w = successors[v][j];
+        if (!reachable[i][w])
+        {
+          reachable[i][w] = true;
+          stack.push_back(w);
+        }
+      }
+    }
+  }
+
+  // strongly connected components, identified by their first instance
+  std::vector<int> component(n);
+  for (int i=0; i<n; i++)
+  {
+    component[i] = i;
+    for (int j=0; j<i; j++)
+    {
+      if (reachable[i][j] && reachable[j][i])
+      {
+        component[i] = component[j];
+        break;
+      }
+    }
+  }
+
+  std::vector<int> inDegree(n, 0);
+  for (int v=0; v<n; v++)
+    for (int j=0; j<successors[v].size(); j++)
+      if (component[v] != component[successors[v][j]])
+        inDegree[component[successors[v][j]]]++;
+
+  // topological sort of the components; ties are resolved by name
+  std::vector< std::vector<std::string> > order;
+  std::set<int> ready;
+  for (int i=0; i<n; i++)
+    if (component[i] == i && inDegree[i] == 0)
+      ready.insert(i);
+
+  while (!ready.empty())
+  {
+    int c = *ready.begin();
+    ready.erase(ready.begin());
+
+    std::vector<std::string> group;
+    for (int v=0; v<n; v++)
+    {
+      if (component[v] != c)
+        continue;
+      group.push_back(names[v]);
+      for (int j=0; j<successors[v].size(); j++)
+      {
+        int w = component[successors[v][j]];
+        if (w != c && --inDegree[w] == 0)
+          ready.insert(w);
+      }
+    }
+    order.push_back(group);
+  }
+
+  return order;
+}
+
+void CompositeModel::SetAlgLoopSolver(const std::string& solver)
+{
+  if (solver == "fixedpoint")
+    settings.SetAlgLoopSolver(Settings::FIXEDPOINT);
+  else if (solver == "kinsol")
+    settings.SetAlgLoopSolver(Settings::KINSOL);
+  else
+    logError("CompositeModel::SetAlgLoopSolver: Unknown solver for algebraic loops '" + solver + "'");
+}
+
+std::string CompositeModel::GetAlgLoopSolverString() const
+{
+  switch (settings.GetAlgLoopSolver())
+  {
+  case Settings::FIXEDPOINT:
+    return std::string("fixedpoint");
+  case Settings::KINSOL:
+    return std::string("kinsol");
+  default:
+    logError("CompositeModel::GetAlgLoopSolverString: Unknown solver for algebraic loops " + std::to_string(settings.GetAlgLoopSolver()));
+    return std::string("unknown");
+  }
+}
+
 void CompositeModel::setVariableFilter(const char* instanceFilter, const char* variableFilter)
 {
   std::regex exp(instanceFilter);
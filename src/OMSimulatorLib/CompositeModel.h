@@ -36,15 +36,27 @@
 #include "DirectedGraph.h"
 #include "Settings.h"
 #include "ResultWriter.h"
+#include "ThreadPool.h"
+#include "KinsolSolver.h"
+#include "ExchangePlan.h"
 #include "Types.h"
 
 #include <fmilib.h>
 #include <string>
 #include <unordered_map>
+#include <map>
 #include <deque>
 
 class CompositeModel
 {
+public:
+  /// states of all FMU instances at a communication point
+  struct Snapshot
+  {
+    double tcur;
+    std::map<std::string, FMUWrapper::State*> states;
+  };
+
 public:
   CompositeModel();
   CompositeModel(const char* descriptionPath);
@@ -58,24 +70,49 @@ public:
   int getInteger(const std::string& var);
   bool getBoolean(const std::string& var);
   void addConnection(const std::string& from, const std::string& to);
+
+  int getVariableHandle(const std::string& var);
+  oms_status_t setRealByHandle(int handle, double value);
+  oms_status_t getRealByHandle(int handle, double* value);
+  oms_status_t setReals(const int* handles, int n, const double* values);
+  oms_status_t getReals(const int* handles, int n, double* values);
+  oms_status_t setSensitivityParameters(const int* handles, int n);
+  oms_status_t getRealSensitivities(const int* handles, int n, double* sensitivities);
+  Variable* getVariable(const std::string& varName);
   void exportDependencyGraph(const std::string& prefix);
 
   void describe();
   void exportXML(const char* filename);
   void importXML(const char* filename);
+  CompositeModel* clone();
 
   oms_status_t simulate();
   oms_status_t doSteps(const int numberOfSteps);
   oms_status_t stepUntil(const double timeValue);
 
-  void initialize();
+  oms_status_t initialize();
   void terminate();
   void reset();
 
   oms_status_t getCurrentTime(double *time);
 
+  Snapshot* saveSnapshot();
+  oms_status_t restoreSnapshot(const Snapshot* snapshot);
+  void freeSnapshot(Snapshot* snapshot);
+  oms_status_t writeSnapshot(const Snapshot* snapshot, const std::string& filename);
+  Snapshot* readSnapshot(const std::string& filename);
+
   Settings& getSettings() {return settings;}
   void SetSolverMethod(std::string instanceName, std::string method);
+  void SetLinearSolver(const std::string& instanceName, const std::string& solver);
+  oms_status_t setInstanceCommunicationInterval(const std::string& instanceName, double communicationInterval);
+  oms_status_t setSolverOption(const std::string& instanceName, const std::string& option, double value);
+  oms_status_t getSolverStatistics(const std::string& instanceName, oms_solver_statistics_t* statistics);
+  void SetAlgLoopSolver(const std::string& solver);
+  std::string GetAlgLoopSolverString() const;
+  void SetMasterAlgorithm(const std::string& algorithm);
+  std::string GetMasterAlgorithmString() const;
+  std::vector< std::vector<std::string> > getInstanceOrder();
 
   void setVariableFilter(const char* instanceFilter, const char* variableFilter);
 
@@ -85,23 +122,53 @@ public:
   const char* getInterfaceVariable(int idx);
 
 private:
-  void updateInputs(DirectedGraph& graph);
+  oms_status_t updateInputs(DirectedGraph& graph, ExchangePlan& plan);
+  void doStep(double stopTime, bool synchronize);
+  oms_status_t doAdaptiveStep(double tmax);
   void emit();
-  void solveAlgLoop(DirectedGraph& graph, const std::vector< std::pair<int, int> >& SCC);
-  Variable* getVariable(const std::string& varName);
+  oms_status_t solveAlgLoop(DirectedGraph& graph, int idx);
+  void freeAlgLoopSolvers();
+  void updateInputs(FMUWrapper* fmu);
 
 private:
   Settings settings;
   ResultWriter *resultFile;
+  ThreadPool *threadPool;
   std::unordered_map<std::string, FMUWrapper*> fmuInstances;
   std::unordered_map<std::string, double> realParameterList;
   std::unordered_map<std::string, int> integerParameterList;
   std::unordered_map<std::string, bool> booleanParameterList;
   DirectedGraph outputsGraph;
   DirectedGraph initialUnknownsGraph;
+  ExchangePlan outputsPlan;
+  ExchangePlan initialUnknownsPlan;
+  std::map< std::pair<const DirectedGraph*, int>, KinsolSolver* > algLoopSolvers;
   double tcur;
   oms_modelState_t modelState;
-  double communicationInterval;
+  double communicationInterval; ///< current macro step size
+  bool canRollback;             ///< all FMU instances can get and set their state
+  std::vector<double> couplingValues;
+
+  // resolved variables for the handle-based API
+  struct VariableHandle
+  {
+    std::string name;
+    FMUWrapper* fmu;
+    Variable* variable;
+  };
+  std::vector<VariableHandle> variableHandles;
+  std::unordered_map<std::string, int> variableHandleIndex;
+  FMUWrapper* sensitivityFMU; ///< FMU instance that integrates the forward sensitivities
+
+  // Gauss-Seidel master: instances in stepping order and their connected inputs
+  struct Connection
+  {
+    FMUWrapper* outputFMU;
+    const Variable* output;
+    const Variable* input;
+  };
+  std::vector<FMUWrapper*> gaussSeidelOrder;
+  std::unordered_map<FMUWrapper*, std::vector<Connection> > gaussSeidelInputs;
 
   std::vector<std::string>  interfaceNames;
   std::vector<std::string>  interfaceVariables;
@@ -40,7 +40,6 @@
 #include <map>
 #include <sstream>
 #include <stdlib.h>
-#include <stack>
 #include <algorithm>
 #include <deque>
 
@@ -54,38 +53,44 @@ DirectedGraph::~DirectedGraph()
 
 }
 
-int DirectedGraph::addVariable(const Variable& var)
+size_t DirectedGraph::hashVariable(const Variable& var)
 {
-  nodes.push_back(var);
-  std::vector<int> row;
-  G.push_back(row);
-  return static_cast<int>(nodes.size()) - 1;
+  return CStrHash()(var.getFMUInstanceName().c_str()) ^ (static_cast<size_t>(var.getValueReference()) * (size_t)0x9e3779b97f4a7c15ULL);
 }
 
-void DirectedGraph::addEdge(const Variable& var1, const Variable& var2)
+int DirectedGraph::findVariable(const Variable& var) const
 {
-  int index1 = -1;
-  int index2 = -1;
-
-  for (int i = 0; i < nodes.size(); ++i)
-  {
-    if (var1 == nodes[i])
-      index1 = i;
+  // aliases share the value reference, hence the full comparison
+  std::pair<std::unordered_multimap<size_t, int>::const_iterator, std::unordered_multimap<size_t, int>::const_iterator> range = nodeIndex.equal_range(hashVariable(var));
+  for (std::unordered_multimap<size_t, int>::const_iterator it = range.first; it != range.second; ++it)
+    if (var == nodes[it->second])
+      return it->second;
+  return -1;
+}
 
-    if (var2 == nodes[i])
-      index2 = i;
+/**
+ * Adds a node to the graph unless it already contains the variable.
+ *
+ * \return the index of the node
+ */
+int DirectedGraph::addVariable(const Variable& var)
+{
+  int index = findVariable(var);
+  if (-1 != index)
+    return index;
 
-    if (index1 != -1 && index2 != -1)
-      break;
-  }
+  nodes.push_back(var);
+  index = static_cast<int>(nodes.size()) - 1;
+  nodeIndex.insert(std::pair<size_t, int>(hashVariable(var), index));
+  return index;
+}
 
-  if (-1 == index1)
-    index1 = addVariable(var1);
-  if (-1 == index2)
-    index2 = addVariable(var2);
+void DirectedGraph::addEdge(const Variable& var1, const Variable& var2)
+{
+  int index1 = addVariable(var1);
+  int index2 = addVariable(var2);
 
   edges.push_back(std::pair<int, int>(index1, index2));
-  G[index1].push_back(index2);
   sortedConnectionsAreValid = false;
 }
 
@@ -130,106 +135,147 @@ void DirectedGraph::dotExport(const std::string& filename)
 
 void DirectedGraph::includeGraph(const DirectedGraph& graph)
 {
+  std::vector<int> index(graph.nodes.size());
   for (int i = 0; i < graph.nodes.size(); i++)
-    addVariable(graph.nodes[i]);
+    index[i] = addVariable(graph.nodes[i]);
 
   for (int i = 0; i < graph.edges.size(); i++)
-    addEdge(graph.nodes[graph.edges[i].first], graph.nodes[graph.edges[i].second]);
-}
-
-int getEdgeIndex(const std::vector< std::pair<int, int> >& edges, int from, int to)
-{
-  for (int i = 0; i < edges.size(); ++i)
-    if (edges[i].first == from && edges[i].second == to)
-      return i;
-
-  logFatal("getEdgeIndex failed");
-  return -1;
+    edges.push_back(std::pair<int, int>(index[graph.edges[i].first], index[graph.edges[i].second]));
+  if (graph.edges.size() > 0)
+    sortedConnectionsAreValid = false;
 }
 
-void DirectedGraph::strongconnect(int v, std::vector< std::vector<int> > G, int& index, int *d, int *low, std::stack<int>& S, bool *stacked, std::deque< std::vector<int> >& components)
+/**
+ * Builds the successors of all edges in compressed row format. The
+ * successors of edge v are the edges successors[rowPtrs[n]] to
+ * successors[rowPtrs[n+1]-1] with n = edges[v].second, in the order in
+ * which they were added. Of several edges between the same pair of nodes
+ * only the first one is a successor.
+ */
+void DirectedGraph::getSuccessors(std::vector<int>& rowPtrs, std::vector<int>& successors) const
 {
-  // Set the depth index for v to the smallest unused index
-  d[v] = index;
-  low[v] = index;
-  index++;
-  S.push(v);
-  stacked[v] = true;
-
-  // Consider successors of v
-  std::vector<int> successors = G[edges[v].second];
-  for (int i = 0; i < successors.size(); ++i)
+  const int numNodes = static_cast<int>(nodes.size());
+  const int numEdges = static_cast<int>(edges.size());
+
+  rowPtrs.assign(numNodes + 1, 0);
+  for (int i = 0; i < numEdges; ++i)
+    rowPtrs[edges[i].first + 1]++;
+  for (int n = 0; n < numNodes; ++n)
+    rowPtrs[n + 1] += rowPtrs[n];
+
+  std::vector<int> next(rowPtrs.begin(), rowPtrs.end() - 1);
+  std::vector<int> sorted(numEdges);
+  for (int i = 0; i < numEdges; ++i)
+    sorted[next[edges[i].first]++] = i;
+
+  // drop duplicated edges
+  std::vector<int> seen(numNodes, -1);
+  successors.clear();
+  successors.reserve(numEdges);
+  int begin = 0;
+  for (int n = 0; n < numNodes; ++n)
   {
-    int w = getEdgeIndex(edges, edges[v].second, successors[i]);
-    if (d[w] == -1)
+    const int end = rowPtrs[n + 1];
+    rowPtrs[n] = static_cast<int>(successors.size());
+    for (int k = begin; k < end; ++k)
     {
-      // Successor w has not yet been visited; recurse on it
-      strongconnect(w, G, index, d, low, S, stacked, components);
-      low[v] = std::min(low[v], low[w]);
-    }
-    else if (stacked[w])
-    {
-      // Successor w is in stack S and hence in the current SCC
-      // Note: The next line may look odd - but is correct.
-      // It says w.index not w.lowlink; that is deliberate and from the original paper
-      low[v] = std::min(low[v], d[w]);
+      int target = edges[sorted[k]].second;
+      if (seen[target] != n)
+      {
+        seen[target] = n;
+        successors.push_back(sorted[k]);
+      }
     }
+    begin = end;
   }
-
-  // If v is a root node, pop the stack and generate an SCC
-  if (low[v] == d[v])
-  {
-    // start a new strongly connected component
-    std::vector<int> SCC;
-    int w;
-    do
-    {
-      w = S.top();
-      S.pop();
-      stacked[w] = false;
-      // add w to current strongly connected component
-      SCC.push_back(w);
-    } while (w != v);
-    // output the current strongly connected component
-    components.push_front(SCC);
-  }
+  rowPtrs[numNodes] = static_cast<int>(successors.size());
 }
 
+/**
+ * Tarjan's strongly connected components algorithm on the graph of edges,
+ * i.e. edge v precedes edge w if v ends where w starts. The recursion is
+ * replaced by an explicit stack to handle large models.
+ */
 std::deque< std::vector<int> > DirectedGraph::getSCCs()
 {
-  //std::cout << "Tarjan's strongly connected components algorithm" << std::endl;
-
-  size_t numVertices = edges.size();
-  int *d = new int[numVertices];
-  std::fill(d, d + numVertices, -1);
-  int *low = new int[numVertices];
-  int *scc = new int[numVertices];
-  bool *stacked = new bool[numVertices];
-  std::stack<int> S;
+  const int numVertices = static_cast<int>(edges.size());
+  std::vector<int> rowPtrs;
+  std::vector<int> successors;
+  getSuccessors(rowPtrs, successors);
+
+  std::vector<int> d(numVertices, -1);
+  std::vector<int> low(numVertices);
+  std::vector<bool> stacked(numVertices, false);
+  std::vector<int> S;
+  std::vector< std::pair<int, int> > callStack; // vertex and position of its next successor
   int index = 0;
   std::deque< std::vector<int> > components;
 
-  for (int v = 0; v < numVertices; ++v)
+  for (int root = 0; root < numVertices; ++root)
   {
-    if (d[v] == -1)
-      strongconnect(v, G, index, d, low, S, stacked, components);
-  }
+    if (d[root] != -1)
+      continue;
 
-  // dump strongly connected components
-  //std::cout << "Strongly connected components:" << std::endl;
-  //for (int i=0; i<components.size(); ++i)
-  //{
-  //  for (int j=0; j<components[i].size(); ++j)
-  //  {
-  //    int v = components[i][j];
-  //    std::cout << nodes[v].getFMUInstanceName() << "." << nodes[v].getName() << " ";
-  //  }
-  //  std::cout << std::endl;
-  //}
-
-  delete[] d;
-  delete[] low;
-  delete[] scc;
+    d[root] = low[root] = index++;
+    S.push_back(root);
+    stacked[root] = true;
+    callStack.push_back(std::pair<int, int>(root, rowPtrs[edges[root].second]));
+
+    while (!callStack.empty())
+    {
+      const int v = callStack.back().first;
+      const int pos = callStack.back().second;
+
+      if (pos < rowPtrs[edges[v].second + 1])
+      {
+        // Consider the next successor of v
+        callStack.back().second++;
+        int w = successors[pos];
+        if (d[w] == -1)
+        {
+          // Successor w has not yet been visited; descend into it
+          d[w] = low[w] = index++;
+          S.push_back(w);
+          stacked[w] = true;
+          callStack.push_back(std::pair<int, int>(w, rowPtrs[edges[w].second]));
+        }
+        else if (stacked[w])
+        {
+          // Successor w is in stack S and hence in the current SCC
+          // Note: The next line may look odd - but is correct.
+          // It says w.index not w.lowlink; that is deliberate and from the original paper
+          low[v] = std::min(low[v], d[w]);
+        }
+        continue;
+      }
+
+      // all successors of v are done
+      callStack.pop_back();
+      if (!callStack.empty())
+      {
+        int u = callStack.back().first;
+        low[u] = std::min(low[u], low[v]);
+      }
+
+      // If v is a root node, pop the stack and generate an SCC
+      if (low[v] == d[v])
+      {
+        // start a new strongly connected component
+        std::vector<int> SCC;
+        int w;
+        do
+        {
+          w = S.back();
+          S.pop_back();
+          stacked[w] = false;
+          // add w to current strongly connected component
+          SCC.push_back(w);
+        } while (w != v);
+        // output the current strongly connected component
+        components.push_front(SCC);
+      }
+    }
+  }
 
   return components;
 }
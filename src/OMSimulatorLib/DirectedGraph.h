@@ -39,7 +39,7 @@
 #include <vector>
 #include <map>
 #include <deque>
-#include <stack>
+#include <unordered_map>
 
 class DirectedGraph
 {
@@ -61,12 +61,16 @@ public:
 private:
   std::deque< std::vector<int> > getSCCs();
   void calculateSortedConnections();
-  void strongconnect(int v, std::vector< std::vector<int> > G, int& index, int *d, int *low, std::stack<int>& S, bool *stacked, std::deque< std::vector<int> >& components);
+  void getSuccessors(std::vector<int>& rowPtrs, std::vector<int>& successors) const;
+  int findVariable(const Variable& var) const;
+  static size_t hashVariable(const Variable& var);
 
 private:
-  std::vector< std::vector<int> > G;
   std::vector< std::vector< std::pair<int, int> > > sortedConnections;
   bool sortedConnectionsAreValid;
+
+  // node indices by hash of FMU instance and value reference
+  std::unordered_multimap<size_t, int> nodeIndex;
 };
 
 #endif
@@ -0,0 +1,309 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-CurrentYear, Open Source Modelica Consortium (OSMC),
+ * c/o Linköpings universitet, Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF GPL VERSION 3 LICENSE OR
+ * THIS OSMC PUBLIC LICENSE (OSMC-PL) VERSION 1.2.
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES
+ * RECIPIENT'S ACCEPTANCE OF THE OSMC PUBLIC LICENSE OR THE GPL VERSION 3,
+ * ACCORDING TO RECIPIENTS CHOICE.
+ *
+ * The OpenModelica software and the Open Source Modelica
+ * Consortium (OSMC) Public License (OSMC-PL) are obtained
+ * from OSMC, either from the above address,
+ * from the URLs: http://www.ida.liu.se/projects/OpenModelica or
+ * http://www.openmodelica.org, and in the OpenModelica distribution.
+ * GNU version 3 is obtained from: http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without
+ * even the implied warranty of  MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE, EXCEPT AS EXPRESSLY SET FORTH
+ * IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE CONDITIONS OF OSMC-PL.
+ *
+ * See the full OSMC Public License conditions for more details.
+ *
+ */
+
+#include "Ensemble.h"
+#include "CompositeModel.h"
+#include "Logging.h"
+#include "Util.h"
+#include "Variable.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+
+#ifndef _WIN32
+  #include <sys/types.h>
+  #include <sys/wait.h>
+  #include <unistd.h>
+#endif
+
+static std::vector<std::string> split(const std::string& line)
+{
+  std::vector<std::string> entries;
+  std::stringstream line_(line);
+  std::string entry;
+  while (std::getline(line_, entry, ','))
+  {
+    trim(entry);
+    entries.push_back(entry);
+  }
+  return entries;
+}
+
+Ensemble::Ensemble(CompositeModel& model)
+  : model(model)
+{
+  logTrace();
+}
+
+Ensemble::~Ensemble()
+{
+  logTrace();
+}
+
+/**
+ * The parameter table is a CSV file. The header contains the names of the
+ * parameters (and inputs) and each further line the values of one run.
+ */
+bool Ensemble::loadParameterTable(const std::string& filename)
+{
+  logTrace();
+
+  std::ifstream file(filename.c_str());
+  if (!file.is_open())
+  {
+    logError("Ensemble::loadParameterTable: Couldn't open \"" + filename + "\"");
+    return false;
+  }
+
+  std::string line;
+  if (!std::getline(file, line))
+  {
+    logError("Ensemble::loadParameterTable: \"" + filename + "\" is empty");
+    return false;
+  }
+
+  variables = split(line);
+  for (auto& name: variables)
+  {
+    Variable* var = model.getVariable(name);
+    if (!var || !(var->isParameter() || var->isInput()))
+    {
+      logError("Ensemble::loadParameterTable: " + name + " is neither a parameter nor an input");
+      return false;
+    }
+    if (!var->isTypeReal() && !var->isTypeInteger() && !var->isTypeBoolean())
+    {
+      logError("Ensemble::loadParameterTable: Unsupported type of " + name);
+      return false;
+    }
+  }
+
+  values.clear();
+  for (int lineNumber = 2; std::getline(file, line); ++lineNumber)
+  {
+    trim(line);
+    if (line.empty())
+      continue;
+
+    std::vector<std::string> entries = split(line);
+    if (entries.size() != variables.size())
+    {
+      logError("Ensemble::loadParameterTable: Line " + std::to_string(lineNumber) + " of \"" + filename + "\" has " + std::to_string(entries.size()) + " instead of " + std::to_string(variables.size()) + " values");
+      return false;
+    }
+
+    std::vector<double> row(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+      try
+      {
+        row[i] = std::stod(entries[i]);
+      }
+      catch (const std::exception&)
+      {
+        logError("Ensemble::loadParameterTable: Invalid value \"" + entries[i] + "\" in line " + std::to_string(lineNumber) + " of \"" + filename + "\"");
+        return false;
+      }
+    }
+    values.push_back(row);
+  }
+
+  logInfo("Ensemble: " + std::to_string(values.size()) + " runs with " + std::to_string(variables.size()) + " parameters");
+  return true;
+}
+
+oms_status_t Ensemble::run(int numWorkers, const std::string& resultFile)
+{
+  logTrace();
+
+#ifdef _WIN32
+  logError("Ensemble::run: Ensembles aren't supported on Windows");
+  return oms_status_error;
+#else
+  if (numWorkers < 1)
+  {
+    logError("Ensemble::run: Number of workers needs to be at least 1");
+    return oms_status_error;
+  }
+
+  RunInfo failed = {oms_status_error, 0.0};
+  runs.assign(values.size(), failed);
+
+  typedef std::chrono::steady_clock clock;
+  clock::time_point startTime = clock::now();
+  std::map< pid_t, std::pair<int, clock::time_point> > active;
+  int next = 0;
+
+  while (next < values.size() || !active.empty())
+  {
+    // start runs until all workers are busy
+    while (next < values.size() && active.size() < numWorkers)
+    {
+      // don't let the children inherit buffered output
+      std::cout.flush();
+      fflush(NULL);
+
+      pid_t pid = fork();
+      if (pid < 0)
+      {
+        logError("Ensemble::run: fork() failed for run " + std::to_string(next));
+        next++;
+        continue;
+      }
+      if (pid == 0)
+      {
+        // child process; _exit skips the destructors of the parent's objects (e.g. the FMU cache)
+        oms_status_t status = simulate(next, resultFile);
+        std::cout.flush();
+        fflush(NULL);
+        _exit(status);
+      }
+      active[pid] = std::make_pair(next, clock::now());
+      next++;
+    }
+
+    if (active.empty())
+      continue;
+
+    int wstatus;
+    pid_t pid = waitpid(-1, &wstatus, 0);
+    if (pid < 0)
+    {
+      logError("Ensemble::run: waitpid() failed");
+      break;
+    }
+
+    auto it = active.find(pid);
+    if (it == active.end())
+      continue;
+
+    int run = it->second.first;
+    runs[run].wallTime = std::chrono::duration<double>(clock::now() - it->second.second).count();
+    if (WIFEXITED(wstatus))
+      runs[run].status = (oms_status_t)WEXITSTATUS(wstatus);
+    else
+    {
+      runs[run].status = oms_status_fatal;
+      if (WIFSIGNALED(wstatus))
+        logError("Ensemble::run: Run " + std::to_string(run) + " was terminated by signal " + std::to_string(WTERMSIG(wstatus)));
+    }
+    active.erase(it);
+  }
+
+  double totalTime = std::chrono::duration<double>(clock::now() - startTime).count();
+
+  // summary
+  int numFailed = 0;
+  logInfo("Ensemble summary:");
+  for (int i = 0; i < runs.size(); ++i)
+  {
+    bool ok = oms_status_ok == runs[i].status || oms_status_warning == runs[i].status;
+    if (!ok)
+      numFailed++;
+    logInfo("  run " + std::to_string(i) + ": " + (ok ? "ok" : "failed") + ", " + std::to_string(runs[i].wallTime) + "s");
+  }
+  logInfo("  " + std::to_string(runs.size() - numFailed) + " of " + std::to_string(runs.size()) + " runs succeeded in " + std::to_string(totalTime) + "s using " + std::to_string(numWorkers) + " workers");
+
+  if (!resultFile.empty())
+    writeSummary(getResultFile(resultFile, -1));
+
+  return numFailed > 0 ? oms_status_error : oms_status_ok;
+#endif
+}
+
+oms_status_t Ensemble::simulate(int run, const std::string& resultFile)
+{
+  logTrace();
+
+  for (size_t i = 0; i < variables.size(); ++i)
+  {
+    Variable* var = model.getVariable(variables[i]);
+    if (var->isTypeReal())
+      model.setReal(variables[i], values[run][i]);
+    else if (var->isTypeInteger())
+      model.setInteger(variables[i], (int)values[run][i]);
+    else
+      model.setBoolean(variables[i], values[run][i] != 0.0);
+  }
+
+  if (resultFile.empty())
+    model.getSettings().ClearResultFile();
+  else
+    model.getSettings().SetResultFile(getResultFile(resultFile, run).c_str());
+
+  oms_status_t status = model.initialize();
+  if (oms_status_ok == status)
+    status = model.simulate();
+  model.terminate();
+  return status;
+}
+
+/**
+ * Inserts the run index before the extension, e.g. "model_res.mat" becomes
+ * "model_res_3.mat". The summary (run = -1) is "model_res_summary.csv".
+ */
+std::string Ensemble::getResultFile(const std::string& resultFile, int run) const
+{
+  boost::filesystem::path path(resultFile);
+  std::string suffix = run < 0 ? std::string("_summary.csv") : "_" + std::to_string(run) + path.extension().string();
+  return (path.parent_path() / (path.stem().string() + suffix)).string();
+}
+
+void Ensemble::writeSummary(const std::string& filename) const
+{
+  std::ofstream file(filename.c_str());
+  if (!file.is_open())
+  {
+    logError("Ensemble::writeSummary: Couldn't create \"" + filename + "\"");
+    return;
+  }
+
+  file << "run,status,wallTime";
+  for (auto& name: variables)
+    file << "," << name;
+  file << std::endl;
+
+  file.precision(16);
+  for (size_t i = 0; i < runs.size(); ++i)
+  {
+    file << i << "," << runs[i].status << "," << runs[i].wallTime;
+    for (auto& value: values[i])
+      file << "," << value;
+    file << std::endl;
+  }
+  logInfo("Ensemble summary: " + filename);
+}
@@ -0,0 +1,81 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-CurrentYear, Open Source Modelica Consortium (OSMC),
+ * c/o Linköpings universitet, Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF GPL VERSION 3 LICENSE OR
+ * THIS OSMC PUBLIC LICENSE (OSMC-PL) VERSION 1.2.
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES
+ * RECIPIENT'S ACCEPTANCE OF THE OSMC PUBLIC LICENSE OR THE GPL VERSION 3,
+ * ACCORDING TO RECIPIENTS CHOICE.
+ *
+ * The OpenModelica software and the Open Source Modelica
+ * Consortium (OSMC) Public License (OSMC-PL) are obtained
+ * from OSMC, either from the above address,
+ * from the URLs: http://www.ida.liu.se/projects/OpenModelica or
+ * http://www.openmodelica.org, and in the OpenModelica distribution.
+ * GNU version 3 is obtained from: http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without
+ * even the implied warranty of  MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE, EXCEPT AS EXPRESSLY SET FORTH
+ * IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE CONDITIONS OF OSMC-PL.
+ *
+ * See the full OSMC Public License conditions for more details.
+ *
+ */
+
+#ifndef _OMS_ENSEMBLE_H_
+#define _OMS_ENSEMBLE_H_
+
+#include "Types.h"
+
+#include <string>
+#include <vector>
+
+class CompositeModel;
+
+/**
+ * \brief Runs a composite model for a table of parameter sets.
+ *
+ * The model is loaded only once. Each run is simulated in a forked process
+ * that inherits the extracted and loaded FMUs, i.e., runs neither share FMU
+ * instances nor threads. At most numWorkers runs are active at a time.
+ */
+class Ensemble
+{
+public:
+  Ensemble(CompositeModel& model);
+  ~Ensemble();
+
+  bool loadParameterTable(const std::string& filename);
+  oms_status_t run(int numWorkers, const std::string& resultFile);
+
+private:
+  oms_status_t simulate(int run, const std::string& resultFile);
+  std::string getResultFile(const std::string& resultFile, int run) const;
+  void writeSummary(const std::string& filename) const;
+
+private:
+  CompositeModel& model;
+  std::vector<std::string> variables;         ///< one column per variable
+  std::vector< std::vector<double> > values; ///< one row per run
+
+  struct RunInfo
+  {
+    oms_status_t status;
+    double wallTime; ///< seconds
+  };
+  std::vector<RunInfo> runs;
+
+private:
+  // Stop the compiler generating methods of copy the object
+  Ensemble(Ensemble const& copy);            // Not Implemented
+  Ensemble& operator=(Ensemble const& copy); // Not Implemented
+};
+
+#endif
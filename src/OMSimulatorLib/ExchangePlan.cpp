@@ -0,0 +1,241 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-CurrentYear, Open Source Modelica Consortium (OSMC),
+ * c/o Linköpings universitet, Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF GPL VERSION 3 LICENSE OR
+ * THIS OSMC PUBLIC LICENSE (OSMC-PL) VERSION 1.2.
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES
+ * RECIPIENT'S ACCEPTANCE OF THE OSMC PUBLIC LICENSE OR THE GPL VERSION 3,
+ * ACCORDING TO RECIPIENTS CHOICE.
+ *
+ * The OpenModelica software and the Open Source Modelica
+ * Consortium (OSMC) Public License (OSMC-PL) are obtained
+ * from OSMC, either from the above address,
+ * from the URLs: http://www.ida.liu.se/projects/OpenModelica or
+ * http://www.openmodelica.org, and in the OpenModelica distribution.
+ * GNU version 3 is obtained from: http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without
+ * even the implied warranty of  MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE, EXCEPT AS EXPRESSLY SET FORTH
+ * IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE CONDITIONS OF OSMC-PL.
+ *
+ * See the full OSMC Public License conditions for more details.
+ *
+ */
+
+#include "ExchangePlan.h"
+#include "FMUWrapper.h"
+#include "Logging.h"
+
+#include <set>
+
+/**
+ * Collects all inputs of the same FMU that the given node depends on, i.e.
+ * all inputs that can be reached backwards without passing a connection.
+ */
+static const std::vector<int>& getDependencies(int node, const std::vector< std::vector<int> >& predecessors, const DirectedGraph& graph, std::vector< std::vector<int> >& dependencies, std::vector<bool>& visited)
+{
+  if (visited[node])
+    return dependencies[node];
+  visited[node] = true;
+
+  std::set<int> inputs;
+  for (int i=0; i<predecessors[node].size(); ++i)
+  {
+    int pred = predecessors[node][i];
+    if (graph.nodes[pred].isInput())
+      inputs.insert(pred);
+    else
+    {
+      const std::vector<int>& deps = getDependencies(pred, predecessors, graph, dependencies, visited);
+      inputs.insert(deps.begin(), deps.end());
+    }
+  }
+
+  dependencies[node].assign(inputs.begin(), inputs.end());
+  return dependencies[node];
+}
+
+static unsigned int getBatch(std::vector<ExchangePlan::Batch>& batches, FMUWrapper* fmu)
+{
+  for (unsigned int i=0; i<batches.size(); ++i)
+    if (batches[i].fmu == fmu)
+      return i;
+
+  ExchangePlan::Batch batch;
+  batch.fmu = fmu;
+  batches.push_back(batch);
+  return batches.size() - 1;
+}
+
+ExchangePlan::ExchangePlan()
+{
+}
+
+ExchangePlan::~ExchangePlan()
+{
+}
+
+void ExchangePlan::build(DirectedGraph& graph, std::unordered_map<std::string, FMUWrapper*>& fmuInstances)
+{
+  logTrace();
+  const std::vector< std::vector< std::pair<int, int> > >& sortedConnections = graph.getSortedConnections();
+  phases.clear();
+
+  // FMU-internal dependencies (all edges except the connections)
+  std::vector< std::vector<int> > predecessors(graph.nodes.size());
+  for (int i=0; i<graph.edges.size(); ++i)
+  {
+    int from = graph.edges[i].first;
+    int to = graph.edges[i].second;
+    if (!(graph.nodes[from].isOutput() && graph.nodes[to].isInput()))
+      predecessors[to].push_back(from);
+  }
+  std::vector< std::vector<int> > dependencies(graph.nodes.size());
+  std::vector<bool> visited(graph.nodes.size(), false);
+
+  std::set<int> inputsOfCurrentPhase;
+  for (int i=0; i<sortedConnections.size(); ++i)
+  {
+    if (sortedConnections[i].size() > 1)
+    {
+      Phase phase;
+      phase.algLoop = i;
+      phases.push_back(phase);
+      inputsOfCurrentPhase.clear();
+      continue;
+    }
+
+    int output = sortedConnections[i][0].first;
+    int input = sortedConnections[i][0].second;
+    const Variable& outputVar = graph.nodes[output];
+    const Variable& inputVar = graph.nodes[input];
+
+    bool isReal = outputVar.isTypeReal() && inputVar.isTypeReal();
+    bool isInteger = outputVar.isTypeInteger() && inputVar.isTypeInteger();
+    bool isBoolean = outputVar.isTypeBoolean() && inputVar.isTypeBoolean();
+    if (!isReal && !isInteger && !isBoolean)
+    {
+      logWarning("ExchangePlan::build: connection " + outputVar.getFMUInstanceName() + "." + outputVar.getName() + " -> " + inputVar.getFMUInstanceName() + "." + inputVar.getName() + " is ignored due to mismatching types");
+      continue;
+    }
+
+    // start a new phase if the output depends on an input of the current phase
+    bool newPhase = phases.empty() || phases.back().algLoop >= 0;
+    if (!newPhase)
+    {
+      const std::vector<int>& deps = getDependencies(output, predecessors, graph, dependencies, visited);
+      for (int j=0; j<deps.size() && !newPhase; ++j)
+        if (inputsOfCurrentPhase.count(deps[j]))
+          newPhase = true;
+    }
+    if (newPhase)
+    {
+      Phase phase;
+      phase.algLoop = -1;
+      phases.push_back(phase);
+      inputsOfCurrentPhase.clear();
+    }
+
+    Phase& phase = phases.back();
+    inputsOfCurrentPhase.insert(input);
+    if (!isReal)
+    {
+      Scalar scalar;
+      scalar.outputFMU = fmuInstances[outputVar.getFMUInstanceName()];
+      scalar.output = &outputVar;
+      scalar.inputFMU = fmuInstances[inputVar.getFMUInstanceName()];
+      scalar.input = &inputVar;
+      scalar.value = 0;
+      phase.scalars.push_back(scalar);
+      continue;
+    }
+
+    Copy copy;
+    copy.outputBatch = getBatch(phase.outputs, fmuInstances[outputVar.getFMUInstanceName()]);
+    copy.outputIndex = phase.outputs[copy.outputBatch].vr.size();
+    phase.outputs[copy.outputBatch].vr.push_back(outputVar.getValueReference());
+    copy.inputBatch = getBatch(phase.inputs, fmuInstances[inputVar.getFMUInstanceName()]);
+    copy.inputIndex = phase.inputs[copy.inputBatch].vr.size();
+    phase.inputs[copy.inputBatch].vr.push_back(inputVar.getValueReference());
+    phase.copies.push_back(copy);
+  }
+
+  // allocate buffers
+  for (int i=0; i<phases.size(); ++i)
+  {
+    for (int j=0; j<phases[i].outputs.size(); ++j)
+      phases[i].outputs[j].values.resize(phases[i].outputs[j].vr.size());
+    for (int j=0; j<phases[i].inputs.size(); ++j)
+      phases[i].inputs[j].values.resize(phases[i].inputs[j].vr.size());
+  }
+
+  logDebug("ExchangePlan::build: " + std::to_string(sortedConnections.size()) + " sorted connections in " + std::to_string(phases.size()) + " phases");
+}
+
+void ExchangePlan::exchange(Phase& phase)
+{
+  for (int i=0; i<phase.outputs.size(); ++i)
+  {
+    Batch& batch = phase.outputs[i];
+    batch.fmu->getReals(&batch.vr[0], batch.vr.size(), &batch.values[0]);
+  }
+
+  for (int i=0; i<phase.scalars.size(); ++i)
+  {
+    Scalar& scalar = phase.scalars[i];
+    if (scalar.output->isTypeInteger())
+      scalar.value = scalar.outputFMU->getInteger(*scalar.output);
+    else
+      scalar.value = scalar.outputFMU->getBoolean(*scalar.output) ? 1 : 0;
+  }
+
+  for (int i=0; i<phase.copies.size(); ++i)
+  {
+    const Copy& copy = phase.copies[i];
+    phase.inputs[copy.inputBatch].values[copy.inputIndex] = phase.outputs[copy.outputBatch].values[copy.outputIndex];
+  }
+
+  // instances between two of their own communication points keep their inputs
+  for (int i=0; i<phase.inputs.size(); ++i)
+  {
+    Batch& batch = phase.inputs[i];
+    if (!batch.fmu->getHoldInputs())
+      batch.fmu->setRealInputs(&batch.vr[0], batch.vr.size(), &batch.values[0]);
+  }
+
+  for (int i=0; i<phase.scalars.size(); ++i)
+  {
+    Scalar& scalar = phase.scalars[i];
+    if (scalar.inputFMU->getHoldInputs())
+      continue;
+    if (scalar.input->isTypeInteger())
+      scalar.inputFMU->setIntegerInput(*scalar.input, scalar.value);
+    else
+      scalar.inputFMU->setBooleanInput(*scalar.input, scalar.value != 0);
+  }
+}
+
+/**
+ * Reads the current values of all real outputs that are exchanged outside
+ * of algebraic loops, phase by phase.
+ */
+void ExchangePlan::getOutputs(std::vector<double>& values)
+{
+  values.clear();
+  for (int i=0; i<phases.size(); ++i)
+  {
+    for (int j=0; j<phases[i].outputs.size(); ++j)
+    {
+      Batch& batch = phases[i].outputs[j];
+      batch.fmu->getReals(&batch.vr[0], batch.vr.size(), &batch.values[0]);
+      values.insert(values.end(), batch.values.begin(), batch.values.end());
+    }
+  }
+}
@@ -0,0 +1,105 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-CurrentYear, Open Source Modelica Consortium (OSMC),
+ * c/o Linköpings universitet, Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF GPL VERSION 3 LICENSE OR
+ * THIS OSMC PUBLIC LICENSE (OSMC-PL) VERSION 1.2.
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES
+ * RECIPIENT'S ACCEPTANCE OF THE OSMC PUBLIC LICENSE OR THE GPL VERSION 3,
+ * ACCORDING TO RECIPIENTS CHOICE.
+ *
+ * The OpenModelica software and the Open Source Modelica
+ * Consortium (OSMC) Public License (OSMC-PL) are obtained
+ * from OSMC, either from the above address,
+ * from the URLs: http://www.ida.liu.se/projects/OpenModelica or
+ * http://www.openmodelica.org, and in the OpenModelica distribution.
+ * GNU version 3 is obtained from: http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without
+ * even the implied warranty of  MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE, EXCEPT AS EXPRESSLY SET FORTH
+ * IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE CONDITIONS OF OSMC-PL.
+ *
+ * See the full OSMC Public License conditions for more details.
+ *
+ */
+
+#ifndef _OMS_EXCHANGE_PLAN_H_
+#define _OMS_EXCHANGE_PLAN_H_
+
+#include "DirectedGraph.h"
+#include "Variable.h"
+
+#include <fmilib.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+class FMUWrapper;
+
+/**
+ * \brief Precomputed data exchange for the sorted connections of a graph.
+ *
+ * The sorted connections are split into phases. A phase is either an
+ * algebraic loop or a sequence of connections whose outputs don't depend
+ * on any input that is set within the same phase. Each phase reads all
+ * its outputs with one vectorised get per source FMU and writes all its
+ * inputs with one vectorised set per target FMU.
+ */
+class ExchangePlan
+{
+public:
+  struct Batch
+  {
+    FMUWrapper* fmu;
+    std::vector<fmi2_value_reference_t> vr;
+    std::vector<double> values;
+  };
+
+  struct Copy
+  {
+    unsigned int outputBatch;
+    unsigned int outputIndex;
+    unsigned int inputBatch;
+    unsigned int inputIndex;
+  };
+
+  /// integer and boolean connections are exchanged one by one
+  struct Scalar
+  {
+    FMUWrapper* outputFMU;
+    const Variable* output;
+    FMUWrapper* inputFMU;
+    const Variable* input;
+    int value;
+  };
+
+  struct Phase
+  {
+    int algLoop; ///< index of the algebraic loop in the sorted connections or -1
+    std::vector<Batch> outputs;
+    std::vector<Batch> inputs;
+    std::vector<Copy> copies;
+    std::vector<Scalar> scalars;
+  };
+
+  ExchangePlan();
+  ~ExchangePlan();
+
+  void build(DirectedGraph& graph, std::unordered_map<std::string, FMUWrapper*>& fmuInstances);
+  void clear() {phases.clear();}
+
+  std::vector<Phase>& getPhases() {return phases;}
+  void exchange(Phase& phase);
+  void getOutputs(std::vector<double>& values);
+
+private:
+  std::vector<Phase> phases;
+};
+
+#endif
@@ -0,0 +1,264 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-CurrentYear, Open Source Modelica Consortium (OSMC),
+ * c/o Linköpings universitet, Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF GPL VERSION 3 LICENSE OR
+ * THIS OSMC PUBLIC LICENSE (OSMC-PL) VERSION 1.2.
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES
+ * RECIPIENT'S ACCEPTANCE OF THE OSMC PUBLIC LICENSE OR THE GPL VERSION 3,
+ * ACCORDING TO RECIPIENTS CHOICE.
+ *
+ * The OpenModelica software and the Open Source Modelica
+ * Consortium (OSMC) Public License (OSMC-PL) are obtained
+ * from OSMC, either from the above address,
+ * from the URLs: http://www.ida.liu.se/projects/OpenModelica or
+ * http://www.openmodelica.org, and in the OpenModelica distribution.
+ * GNU version 3 is obtained from: http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without
+ * even the implied warranty of  MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE, EXCEPT AS EXPRESSLY SET FORTH
+ * IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE CONDITIONS OF OSMC-PL.
+ *
+ * See the full OSMC Public License conditions for more details.
+ *
+ */
+
+#include "FMUCache.h"
+#include "GlobalSettings.h"
+#include "Logging.h"
+
+#include <fmilib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+static void fmuCacheLogger(jm_callbacks* c, jm_string module, jm_log_level_enu_t log_level, jm_string message)
+{
+  if (jm_log_level_error >= log_level)
+    logError("module " + std::string(module) + ": " + std::string(message));
+  else
+    logDebug("module " + std::string(module) + ": " + std::string(message));
+}
+
+FMUCache::FMUCache()
+  : persistent(false)
+{
+  callbacks.malloc = malloc;
+  callbacks.calloc = calloc;
+  callbacks.realloc = realloc;
+  callbacks.free = free;
+  callbacks.logger = fmuCacheLogger;
+  callbacks.log_level = jm_log_level_warning;
+  callbacks.context = 0;
+}
+
+FMUCache::~FMUCache()
+{
+}
+
+FMUCache& FMUCache::getInstance()
+{
+  // The only instance
+  static FMUCache instance;
+  return instance;
+}
+
+/**
+ * FNV-1a hash of the file content. The hash is remembered as long as the
+ * file doesn't change, i.e. each file is read only once.
+ */
+bool FMUCache::getHash(const std::string& fmuPath, uint64_t& hash)
+{
+  boost::system::error_code ec;
+  std::time_t lastWriteTime = boost::filesystem::last_write_time(fmuPath, ec);
+  uintmax_t size = boost::filesystem::file_size(fmuPath, ec);
+  if (ec)
+    return false;
+
+  std::string path = boost::filesystem::canonical(fmuPath, ec).string();
+  auto it = fileHashes.find(path);
+  if (it != fileHashes.end() && it->second.lastWriteTime == lastWriteTime && it->second.size == size)
+  {
+    hash = it->second.hash;
+    return true;
+  }
+
+  FILE* pFile = fopen(fmuPath.c_str(), "rb");
+  if (!pFile)
+    return false;
+
+  hash = 14695981039346656037ULL;
+  unsigned char buffer[65536];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), pFile)) > 0)
+  {
+    for (size_t i=0; i<n; ++i)
+    {
+      hash ^= buffer[i];
+      hash *= 1099511628211ULL;
+    }
+  }
+  fclose(pFile);
+
+  FileHash fileHash;
+  fileHash.lastWriteTime = lastWriteTime;
+  fileHash.size = size;
+  fileHash.hash = hash;
+  fileHashes[path] = fileHash;
+  return true;
+}
+
+/**
+ * Extracts the FMU to the given directory. The FMU is first extracted to a
+ * temporary directory which is then renamed, so that other processes never
+ * see an incomplete extraction in a persistent cache.
+ */
+bool FMUCache::extract(const std::string& fmuPath, const std::string& directory)
+{
+  char* tempDir = fmi_import_mk_temp_dir(&callbacks, GlobalSettings::getInstance().GetTempDirectory().c_str(), "temp_");
+  if (!tempDir)
+    return false;
+
+  fmi_import_context_t* context = fmi_import_allocate_context(&callbacks);
+  fmi_version_enu_t version = fmi_import_get_fmi_version(context, fmuPath.c_str(), tempDir);
+  fmi_import_free_context(context);
+  if (fmi_version_2_0_enu != version)
+  {
+    logError("Unsupported FMI version: " + std::string(fmi_version_to_string(version)));
+    fmi_import_rmdir(&callbacks, tempDir);
+    callbacks.free(tempDir);
+    return false;
+  }
+
+  boost::system::error_code ec;
+  boost::filesystem::rename(tempDir, directory, ec);
+  if (ec)
+  {
+    // another process might have extracted the same FMU in the meantime
+    fmi_import_rmdir(&callbacks, tempDir);
+    callbacks.free(tempDir);
+    return boost::filesystem::is_directory(directory);
+  }
+
+  callbacks.free(tempDir);
+  return true;
+}
+
+/**
+ * Returns the directory of the extracted FMU or an empty string if the FMU
+ * couldn't be extracted. Every call has to be paired with release().
+ */
+std::string FMUCache::acquire(const std::string& fmuPath)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  uint64_t hash;
+  if (!getHash(fmuPath, hash))
+  {
+    logError("FMUCache::acquire: Couldn't read " + fmuPath);
+    return "";
+  }
+
+  char hashStr[17];
+  snprintf(hashStr, sizeof(hashStr), "%016llx", (unsigned long long)hash);
+  boost::filesystem::path path = boost::filesystem::path(GlobalSettings::getInstance().GetTempDirectory()) / ("fmu_" + std::string(hashStr));
+  std::string directory = path.string();
+
+  auto it = entries.find(directory);
+  if (it != entries.end())
+  {
+    it->second.useCount++;
+    logDebug("FMUCache::acquire: reusing \"" + directory + "\" for " + fmuPath);
+    return directory;
+  }
+
+  if (!(persistent && boost::filesystem::exists(path / "modelDescription.xml")))
+  {
+    if (boost::filesystem::exists(path))
+      fmi_import_rmdir(&callbacks, directory.c_str());
+    if (!extract(fmuPath, directory))
+      return "";
+  }
+
+  Entry entry;
+  entry.directory = directory;
+  entry.useCount = 1;
+  entry.shared = true;
+  entries[directory] = entry;
+  return directory;
+}
+
+/**
+ * Extracts the FMU to a directory that isn't shared with any other
+ * instance, e.g. for FMUs that can be instantiated only once per process.
+ */
+std::string FMUCache::acquirePrivate(const std::string& fmuPath)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  char* tempDir = fmi_import_mk_temp_dir(&callbacks, GlobalSettings::getInstance().GetTempDirectory().c_str(), "temp_");
+  if (!tempDir)
+    return "";
+  std::string directory(tempDir);
+  callbacks.free(tempDir);
+
+  fmi_import_context_t* context = fmi_import_allocate_context(&callbacks);
+  fmi_version_enu_t version = fmi_import_get_fmi_version(context, fmuPath.c_str(), directory.c_str());
+  fmi_import_free_context(context);
+  if (fmi_version_2_0_enu != version)
+  {
+    logError("Unsupported FMI version: " + std::string(fmi_version_to_string(version)));
+    fmi_import_rmdir(&callbacks, directory.c_str());
+    return "";
+  }
+
+  Entry entry;
+  entry.directory = directory;
+  entry.useCount = 1;
+  entry.shared = false;
+  entries[directory] = entry;
+  return directory;
+}
+
+void FMUCache::release(const std::string& directory)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  auto it = entries.find(directory);
+  if (it == entries.end())
+  {
+    logWarning("FMUCache::release: unknown directory \"" + directory + "\"");
+    return;
+  }
+
+  if (--it->second.useCount > 0)
+    return;
+
+  if (!persistent || !it->second.shared)
+  {
+    if (boost::filesystem::is_directory(directory))
+    {
+      fmi_import_rmdir(&callbacks, directory.c_str());
+      logDebug("removed working directory: \"" + directory + "\"");
+    }
+  }
+  entries.erase(it);
+}
+
+unsigned int FMUCache::getUseCount(const std::string& directory)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  auto it = entries.find(directory);
+  if (it == entries.end())
+    return 0;
+  return it->second.useCount;
+}
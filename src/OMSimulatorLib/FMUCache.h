@@ -0,0 +1,95 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-CurrentYear, Open Source Modelica Consortium (OSMC),
+ * c/o Linköpings universitet, Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF GPL VERSION 3 LICENSE OR
+ * THIS OSMC PUBLIC LICENSE (OSMC-PL) VERSION 1.2.
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES
+ * RECIPIENT'S ACCEPTANCE OF THE OSMC PUBLIC LICENSE OR THE GPL VERSION 3,
+ * ACCORDING TO RECIPIENTS CHOICE.
+ *
+ * The OpenModelica software and the Open Source Modelica
+ * Consortium (OSMC) Public License (OSMC-PL) are obtained
+ * from OSMC, either from the above address,
+ * from the URLs: http://www.ida.liu.se/projects/OpenModelica or
+ * http://www.openmodelica.org, and in the OpenModelica distribution.
+ * GNU version 3 is obtained from: http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without
+ * even the implied warranty of  MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE, EXCEPT AS EXPRESSLY SET FORTH
+ * IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE CONDITIONS OF OSMC-PL.
+ *
+ * See the full OSMC Public License conditions for more details.
+ *
+ */
+
+#ifndef _OMS_FMU_CACHE_H_
+#define _OMS_FMU_CACHE_H_
+
+#include <fmilib.h>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <string>
+#include <stdint.h>
+
+/**
+ * \brief Shares the extracted content of FMUs between all instances.
+ *
+ * FMUs are identified by a hash of their content and extracted only once
+ * to a directory in the temp directory. The directories are reference
+ * counted and removed as soon as they aren't used anymore, unless the
+ * cache is persistent. A persistent cache is also reused across runs.
+ */
+class FMUCache
+{
+public:
+  static FMUCache& getInstance();
+
+  std::string acquire(const std::string& fmuPath);
+  std::string acquirePrivate(const std::string& fmuPath);
+  void release(const std::string& directory);
+  unsigned int getUseCount(const std::string& directory);
+
+  void SetPersistent(bool persistent) {this->persistent = persistent;}
+  bool GetPersistent() const {return persistent;}
+
+private:
+  FMUCache();
+  ~FMUCache();
+
+  // Stop the compiler generating methods of copy the object
+  FMUCache(FMUCache const& copy);            // Not Implemented
+  FMUCache& operator=(FMUCache const& copy); // Not Implemented
+
+  struct Entry
+  {
+    std::string directory;
+    unsigned int useCount;
+    bool shared;
+  };
+
+  struct FileHash
+  {
+    std::time_t lastWriteTime;
+    uintmax_t size;
+    uint64_t hash;
+  };
+
+  bool getHash(const std::string& fmuPath, uint64_t& hash);
+  bool extract(const std::string& fmuPath, const std::string& directory);
+
+  jm_callbacks callbacks;
+  std::mutex mutex;
+  std::map<std::string, Entry> entries;        ///< directory -> entry
+  std::map<std::string, FileHash> fileHashes;  ///< fmu path -> content hash
+  bool persistent;
+};
+
+#endif
@@ -39,6 +39,7 @@
 #include "Util.h"
 #include "Clocks.h"
 #include "ResultWriter.h"
+#include "FMUCache.h"
 
 #include <fmilib.h>
 #include <JM/jm_portability.h>
@@ -49,12 +50,19 @@
 #include <stdlib.h>
 #include <unordered_map>
 #include <regex>
+#include <algorithm>
+#include <cmath>
 
 #include <boost/filesystem.hpp>
 
 #include "cvode/cvode.h"             /* prototypes for CVODE fcts., consts. */
 #include "nvector/nvector_serial.h"  /* serial N_Vector types, fcts., macros */
 #include "cvode/cvode_dense.h"       /* prototype for CVDense */
+#include "cvode/cvode_spgmr.h"       /* prototype for CVSpgmr */
+#include "cvode/cvode_bandpre.h"     /* prototype for CVBandPrecInit */
+#ifdef OMS_WITH_KLU
+#include "cvode/cvode_klu.h"         /* prototype for CVKLU */
+#endif
 #include "sundials/sundials_dense.h" /* definitions DlsMat DENSE_ELEM */
 #include "sundials/sundials_types.h" /* definition of type realtype */
 
@@ -137,8 +145,10 @@ int cvode_rhs(realtype t, N_Vector y, N_Vector ydot, void *user_data)
   for (size_t i = 0; i < fmu->n_states; ++i)
     fmu->states[i] = NV_Ith_S(y, i);
 
-  // set states
+  // set time and states
   fmi2_status_t fmistatus;
+  fmistatus = fmi2_import_set_time(fmu->fmu, t);
+  if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_set_time failed");
   fmistatus = fmi2_import_set_continuous_states(fmu->fmu, fmu->states, fmu->n_states);
   if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_set_continuous_states failed");
   // get state derivatives
@@ -148,15 +158,105 @@ int cvode_rhs(realtype t, N_Vector y, N_Vector ydot, void *user_data)
   for (size_t i = 0; i < fmu->n_states; ++i)
     NV_Ith_S(ydot, i) = fmu->states_der[i];
 
+  // forward sensitivities are stored behind the states
+  if (!fmu->sensitivityParameters.empty())
+    if (!fmu->getSensitivityDerivatives(NV_DATA_S(y) + fmu->n_states, NV_DATA_S(ydot) + fmu->n_states))
+      return -1;
+
+  return 0;
+}
+
+// event indicators of the FMU as root functions, so that CVODE locates the
+// zero-crossings itself
+int cvode_root(realtype t, N_Vector y, realtype *gout, void *user_data)
+{
+  FMUWrapper *fmu = (FMUWrapper*)user_data;
+
+  for (size_t i = 0; i < fmu->n_states; ++i)
+    fmu->states[i] = NV_Ith_S(y, i);
+
+  fmi2_status_t fmistatus;
+  fmistatus = fmi2_import_set_time(fmu->fmu, t);
+  if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_set_time failed");
+  fmistatus = fmi2_import_set_continuous_states(fmu->fmu, fmu->states, fmu->n_states);
+  if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_set_continuous_states failed");
+  fmistatus = fmi2_import_get_event_indicators(fmu->fmu, gout, fmu->n_event_indicators);
+  if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_get_event_indicators failed");
+
+  return 0;
+}
+
+// Jacobian of the states (with sensitivities: the block diagonal
+// approximation that neglects the second derivatives of the sensitivity
+// equations, like the simultaneous corrector of CVODES).
+int cvode_jac(long int N, realtype t, N_Vector y, N_Vector fy, DlsMat Jac, void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3)
+{
+  FMUWrapper *fmu = (FMUWrapper*)user_data;
+  const long int n = fmu->n_states;
+  const std::vector<int>& colptrs = fmu->jacobianColPtrs;
+  const std::vector<int>& rowvals = fmu->jacobianRowVals;
+
+  std::vector<double> values(rowvals.size());
+  if (!fmu->getStateJacobian(t, NV_DATA_S(y), NV_DATA_S(fy), values.data()))
+    return -1;
+
+  for (long int block = 0; block < N; block += n)
+    for (long int j = 0; j < n; ++j)
+      for (int k = colptrs[j]; k < colptrs[j+1]; ++k)
+        DENSE_ELEM(Jac, block+rowvals[k], block+j) = values[k];
+
+  return 0;
+}
+
+#ifdef OMS_WITH_KLU
+// sparse version of cvode_jac for KLU
+int cvode_jac_sparse(realtype t, N_Vector y, N_Vector fy, SlsMat Jac, void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3)
+{
+  FMUWrapper *fmu = (FMUWrapper*)user_data;
+  const int n = fmu->n_states;
+  const std::vector<int>& colptrs = fmu->jacobianColPtrs;
+  const std::vector<int>& rowvals = fmu->jacobianRowVals;
+
+  std::vector<double> values(rowvals.size());
+  if (!fmu->getStateJacobian(t, NV_DATA_S(y), NV_DATA_S(fy), values.data()))
+    return -1;
+
+#ifdef OMS_SUNDIALS_2_7
+  int* jacColPtrs = Jac->indexptrs;
+  int* jacRowVals = Jac->indexvals;
+#else
+  int* jacColPtrs = Jac->colptrs;
+  int* jacRowVals = Jac->rowvals;
+#endif
+
+  int nz = 0;
+  for (int block = 0; block < Jac->N; block += n)
+  {
+    for (int j = 0; j < n; ++j)
+    {
+      jacColPtrs[block+j] = nz;
+      for (int k = colptrs[j]; k < colptrs[j+1]; ++k, ++nz)
+      {
+        jacRowVals[nz] = block + rowvals[k];
+        Jac->data[nz] = values[k];
+      }
+    }
+  }
+  jacColPtrs[Jac->N] = nz;
+
   return 0;
 }
+#endif
 
 FMUWrapper::FMUWrapper(CompositeModel& model, std::string fmuPath, std::string instanceName)
-  : model(model), fmuPath(fmuPath), instanceName(instanceName), solverMethod(EXPLICIT_EULER), clocks(CLOCK_MAX_INDEX), variableFilter(".*")
+  : model(model), fmuPath(fmuPath), instanceName(instanceName), solverMethod(EXPLICIT_EULER), linearSolver(DENSE), clocks(CLOCK_MAX_INDEX, ClockNames, instanceName), variableFilter(".*"), communicationInterval(0.0), holdInputs(false)
 {
   logTrace();
   OMS_TIC(clocks, CLOCK_INSTANTIATION);
 
+  solverData.cvode.mem = NULL;
+  solverStatistics = oms_solver_statistics_t();
+
   if (!boost::filesystem::exists(fmuPath))
     logFatal("Specified file name does not exist: \"" + fmuPath + "\"");
 
@@ -172,25 +272,35 @@ FMUWrapper::FMUWrapper(CompositeModel& model, std::string fmuPath, std::string i
 #endif
   callbacks.context = 0;
 
-  // set temp directory
-  tempDir = fmi_import_mk_temp_dir(&callbacks, GlobalSettings::getInstance().GetTempDirectory().c_str(), "temp_");
-  logInfo("Using \"" + tempDir + "\" as temp directory for " + instanceName);
+  // get the extracted FMU from the cache
+  tempDir = FMUCache::getInstance().acquire(fmuPath);
+  if (tempDir.empty())
+    logFatal("Couldn't extract FMU \"" + fmuPath + "\"");
 
   context = fmi_import_allocate_context(&callbacks);
 
-  // check version of FMU
-  fmi_version_enu_t version = fmi_import_get_fmi_version(context, fmuPath.c_str(), tempDir.c_str());
-  if (fmi_version_2_0_enu != version)
-  {
-    logError("Unsupported FMI version: " + std::string(fmi_version_to_string(version)));
-    return;
-  }
-
   // parse modelDescription.xml
   fmu = fmi2_import_parse_xml(context, tempDir.c_str(), 0);
   if (!fmu)
     logFatal("Error parsing modelDescription.xml");
 
+  // FMUs that can be instantiated only once per process need their own copy
+  // of the binaries, otherwise they would share the loaded library
+  bool onlyOnce = fmi2_import_get_capability(fmu, fmi2_me_canBeInstantiatedOnlyOncePerProcess) || fmi2_import_get_capability(fmu, fmi2_cs_canBeInstantiatedOnlyOncePerProcess);
+  if (onlyOnce && FMUCache::getInstance().getUseCount(tempDir) > 1)
+  {
+    fmi2_import_free(fmu);
+    FMUCache::getInstance().release(tempDir);
+    tempDir = FMUCache::getInstance().acquirePrivate(fmuPath);
+    if (tempDir.empty())
+      logFatal("Couldn't extract FMU \"" + fmuPath + "\"");
+
+    fmu = fmi2_import_parse_xml(context, tempDir.c_str(), 0);
+    if (!fmu)
+      logFatal("Error parsing modelDescription.xml");
+  }
+  logInfo("Using \"" + tempDir + "\" as temp directory for " + instanceName);
+
   // check FMU kind (CS or ME)
   fmuKind = fmi2_import_get_fmu_kind(fmu);
   if (fmi2_fmu_kind_me == fmuKind)
@@ -245,14 +355,28 @@ FMUWrapper::FMUWrapper(CompositeModel& model, std::string fmuPath, std::string i
   fmi2_import_variable_list_t *varList = fmi2_import_get_variable_list(fmu, 0);
   size_t varListSize = fmi2_import_get_variable_list_size(varList);
   logDebug(std::to_string(varListSize) + " variables");
+  // the name table is filled first, since the variables refer into it
+  variableNames.reserve(varListSize);
+  for (size_t i = 0; i < varListSize; ++i)
+    variableNames.push_back(fmi2_import_get_variable_name(fmi2_import_get_variable(varList, i)));
+  allVariables.reserve(varListSize);
   for (size_t i = 0; i < varListSize; ++i)
   {
     fmi2_import_variable_t* var = fmi2_import_get_variable(varList, i);
-    Variable v(var, this);
+    Variable v(var, this, static_cast<unsigned int>(i));
     allVariables.push_back(v);
   }
   fmi2_import_free_variable_list(varList);
 
+  // create the lookup tables; allVariables must not change anymore from here on
+  nameIndex.reserve(allVariables.size());
+  for (unsigned int i = 0; i < allVariables.size(); ++i)
+  {
+    nameIndex.insert(std::make_pair(allVariables[i].getName().c_str(), i));
+    if (allVariables[i].isTypeReal())
+      realVRIndex.insert(std::make_pair(allVariables[i].getValueReference(), i));
+  }
+
   // mark states
   varList = fmi2_import_get_derivatives_list(fmu);
   varListSize = fmi2_import_get_variable_list_size(varList);
@@ -270,6 +394,8 @@ FMUWrapper::FMUWrapper(CompositeModel& model, std::string fmuPath, std::string i
         state_var->markAsState();
       else
         logError("Couldn't find " + std::string(fmi2_import_get_variable_name(varState)));
+      stateVRs.push_back(state_vr);
+      derivativeVRs.push_back(fmi2_import_get_variable_vr(var));
     }
     else
       logError("Couldn't map " + std::string(fmi2_import_get_variable_name(var)) + " to the corresponding state variable");
@@ -333,11 +459,7 @@ FMUWrapper::~FMUWrapper()
   fmi2_import_destroy_dllfmu(fmu);
   fmi2_import_free(fmu);
   fmi_import_free_context(context);
-  if (boost::filesystem::is_directory(tempDir))
-  {
-    fmi_import_rmdir(&callbacks, tempDir.c_str());
-    logDebug("removed working directory: \"" + tempDir + "\"");
-  }
+  FMUCache::getInstance().release(tempDir);
 
   double cpuStats[CLOCK_MAX_INDEX+1];
   clocks.getStats(cpuStats, NULL);
@@ -373,6 +495,21 @@ double FMUWrapper::getReal(const Variable& var)
   return value;
 }
 
+bool FMUWrapper::getReals(const fmi2_value_reference_t* vr, size_t n, double* values)
+{
+  logTrace();
+  if (!fmu)
+    logFatal("FMUWrapper::getReals failed");
+
+  fmi2_status_t status = fmi2_import_get_real(fmu, vr, n, values);
+  if (fmi2_status_ok != status && fmi2_status_warning != status)
+  {
+    logError("FMUWrapper::getReals: fmi2GetReal failed for FMU '" + instanceName + "'");
+    return false;
+  }
+  return true;
+}
+
 int FMUWrapper::getInteger(const std::string& var)
 {
   logTrace();
@@ -458,6 +595,26 @@ bool FMUWrapper::setRealInput(const Variable& var, double value)
   return true;
 }
 
+/**
+ * Sets several real inputs at once. The value references have to belong to
+ * real inputs; this isn't checked here as the caller is expected to validate
+ * them once in advance (see ExchangePlan).
+ */
+bool FMUWrapper::setRealInputs(const fmi2_value_reference_t* vr, size_t n, const double* values)
+{
+  logTrace();
+  if (!fmu)
+    logFatal("FMUWrapper::setRealInputs failed");
+
+  fmi2_status_t status = fmi2_import_set_real(fmu, vr, n, values);
+  if (fmi2_status_ok != status && fmi2_status_warning != status)
+  {
+    logError("FMUWrapper::setRealInputs: fmi2SetReal failed for FMU '" + instanceName + "'");
+    return false;
+  }
+  return true;
+}
+
 bool FMUWrapper::setIntegerInput(const std::string& var, int value)
 {
   logTrace();
@@ -532,14 +689,28 @@ bool FMUWrapper::setRealParameter(const std::string& var, double value)
     logFatal("FMUWrapper::setRealParameter failed");
 
   Variable* v = getVariable(var);
-
-  if (!v || !v->isParameter() || !v->isTypeReal())
+  if (v)
+    return setRealParameter(*v, value);
+  else
   {
     logError("FMUWrapper::setRealParameter: FMU '" + instanceName + "' doesn't contain parameter real " + var);
     return false;
   }
+}
 
-  fmi2_value_reference_t vr = v->getValueReference();
+bool FMUWrapper::setRealParameter(const Variable& var, double value)
+{
+  logTrace();
+  if (!fmu)
+    logFatal("FMUWrapper::setRealParameter failed");
+
+  if (!var.isParameter() || !var.isTypeReal())
+  {
+    logError("FMUWrapper::setRealParameter: FMU '" + instanceName + "' doesn't contain parameter real " + var.getName());
+    return false;
+  }
+
+  fmi2_value_reference_t vr = var.getValueReference();
   fmi2_import_set_real(fmu, &vr, 1, &value);
   return true;
 }
@@ -583,6 +754,314 @@ bool FMUWrapper::setBooleanParameter(const std::string& var, bool value)
   return true;
 }
 
+bool FMUWrapper::getDirectionalDerivative(const fmi2_value_reference_t* unknowns, size_t nUnknowns, const fmi2_value_reference_t* knowns, size_t nKnowns, const double* seed, double* result)
+{
+  logTrace();
+  if (!fmu)
+    logFatal("FMUWrapper::getDirectionalDerivative failed");
+
+  fmi2_status_t fmistatus = fmi2_import_get_directional_derivative(fmu, unknowns, nUnknowns, knowns, nKnowns, seed, result);
+  if (fmi2_status_ok != fmistatus)
+  {
+    logError("FMUWrapper::getDirectionalDerivative: fmi2_import_get_directional_derivative failed for FMU '" + instanceName + "'");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Selects the parameters for the forward sensitivity analysis. The
+ * sensitivities dx/dp are integrated by CVODE along with the states:
+ *
+ *   d/dt dx/dp = df/dx * dx/dp + df/dp
+ *
+ * Both products are evaluated with directional derivatives, which means that
+ * the FMU has to accept parameters as knowns of fmi2GetDirectionalDerivative.
+ * Sensitivities aren't updated at events.
+ */
+bool FMUWrapper::setSensitivityParameters(const std::vector<fmi2_value_reference_t>& parameters)
+{
+  logTrace();
+
+  if (!parameters.empty())
+  {
+    if (!isFMUKindME())
+    {
+      logError("FMUWrapper::setSensitivityParameters: Sensitivities are only supported for FMU ME, '" + instanceName + "' is " + getFMUKind());
+      return false;
+    }
+    if (!providesDirectionalDerivatives())
+    {
+      logError("FMUWrapper::setSensitivityParameters: FMU '" + instanceName + "' doesn't provide directional derivatives");
+      return false;
+    }
+    if (CVODE != solverMethod)
+    {
+      logError("FMUWrapper::setSensitivityParameters: Sensitivities need solver 'cvode' for FMU '" + instanceName + "'");
+      return false;
+    }
+  }
+
+  sensitivityParameters = parameters;
+  return true;
+}
+
+// sensitivities of the start values; only states that are initial unknowns depend on parameters
+bool FMUWrapper::getInitialSensitivities()
+{
+  const size_t n = stateVRs.size();
+  const double one = 1.0;
+
+  std::vector<fmi2_value_reference_t> unknowns;
+  std::vector<size_t> index;
+  for (size_t i = 0; i < n; ++i)
+  {
+    Variable* var = getVariable(stateVRs[i]);
+    if (var && var->isInitialUnknown())
+    {
+      unknowns.push_back(stateVRs[i]);
+      index.push_back(i);
+    }
+  }
+
+  sensitivities.assign(n * sensitivityParameters.size(), 0.0);
+  if (unknowns.empty())
+    return true;
+
+  std::vector<double> dx(unknowns.size());
+  for (size_t j = 0; j < sensitivityParameters.size(); ++j)
+  {
+    if (!getDirectionalDerivative(unknowns.data(), unknowns.size(), &sensitivityParameters[j], 1, &one, dx.data()))
+      return false;
+    for (size_t k = 0; k < index.size(); ++k)
+      sensitivities[j*n + index[k]] = dx[k];
+  }
+  return true;
+}
+
+bool FMUWrapper::getSensitivityDerivatives(const double* S, double* dS)
+{
+  const double one = 1.0;
+  std::vector<double> dfdp(n_states);
+
+  for (size_t j = 0; j < sensitivityParameters.size(); ++j)
+  {
+    if (!getDirectionalDerivative(derivativeVRs.data(), n_states, stateVRs.data(), n_states, S + j*n_states, dS + j*n_states))
+      return false;
+    if (!getDirectionalDerivative(derivativeVRs.data(), n_states, &sensitivityParameters[j], 1, &one, dfdp.data()))
+      return false;
+    for (size_t i = 0; i < n_states; ++i)
+      dS[j*n_states + i] += dfdp[i];
+  }
+  return true;
+}
+
+/**
+ * Sparsity pattern of the state Jacobian from the derivatives dependencies
+ * of the model structure. The diagonal is always part of the pattern.
+ * Afterwards, the columns are colored greedily such that columns of the same
+ * color don't share a row and can be evaluated together.
+ */
+void FMUWrapper::getJacobianSparsity()
+{
+  const size_t n = n_states;
+
+  // value reference -> index in the state vector; the dependencies refer to
+  // the variables themselves, which may come after an alias with the same
+  // value reference
+  std::unordered_map<fmi2_value_reference_t, int> stateIndex;
+  for (size_t j = 0; j < n; ++j)
+    stateIndex[stateVRs[j]] = static_cast<int>(j);
+
+  size_t *startIndex, *dependency;
+  char* factorKind;
+  fmi2_import_get_derivatives_dependencies(fmu, &startIndex, &dependency, &factorKind);
+
+  std::vector< std::vector<int> > columns(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    columns[i].push_back(i);
+    if (!startIndex || ((startIndex[i] + 1 == startIndex[i + 1]) && (dependency[startIndex[i]] == 0)))
+    {
+      // depends on all states
+      for (size_t j = 0; j < n; ++j)
+        columns[j].push_back(i);
+      continue;
+    }
+
+    for (size_t k = startIndex[i]; k < startIndex[i + 1]; ++k)
+    {
+      const Variable& var = allVariables[dependency[k] - 1];
+      if (!var.isTypeReal())
+        continue;
+      std::unordered_map<fmi2_value_reference_t, int>::const_iterator it = stateIndex.find(var.getValueReference());
+      if (it != stateIndex.end())
+        columns[it->second].push_back(i);
+    }
+  }
+
+  jacobianColPtrs.assign(1, 0);
+  jacobianRowVals.clear();
+  std::vector< std::vector<int> > rows(n);
+  for (size_t j = 0; j < n; ++j)
+  {
+    std::sort(columns[j].begin(), columns[j].end());
+    columns[j].erase(std::unique(columns[j].begin(), columns[j].end()), columns[j].end());
+    jacobianRowVals.insert(jacobianRowVals.end(), columns[j].begin(), columns[j].end());
+    jacobianColPtrs.push_back(jacobianRowVals.size());
+    for (size_t k = 0; k < columns[j].size(); ++k)
+      rows[columns[j][k]].push_back(j);
+  }
+
+  // greedy coloring of the column intersection graph
+  std::vector<int> color(n, -1);
+  std::vector<size_t> forbidden;
+  jacobianColorGroups.clear();
+  for (size_t j = 0; j < n; ++j)
+  {
+    forbidden.assign(jacobianColorGroups.size() + 1, n);
+    for (size_t k = 0; k < columns[j].size(); ++k)
+    {
+      const std::vector<int>& neighbours = rows[columns[j][k]];
+      for (size_t l = 0; l < neighbours.size(); ++l)
+        if (color[neighbours[l]] >= 0)
+          forbidden[color[neighbours[l]]] = j;
+    }
+
+    int c = 0;
+    while (forbidden[c] == j)
+      c++;
+    if (c == jacobianColorGroups.size())
+      jacobianColorGroups.push_back(std::vector<int>());
+    jacobianColorGroups[c].push_back(j);
+    color[j] = c;
+  }
+
+  logDebug("Jacobian of '" + instanceName + "': " + std::to_string(jacobianRowVals.size()) + " non-zeros, " + std::to_string(jacobianColorGroups.size()) + " colors");
+}
+
+/**
+ * Non-zero values of the state Jacobian at (t, x) in the order of the
+ * sparsity pattern. Each color group is evaluated with one directional
+ * derivative if the FMU provides them, or otherwise with one forward
+ * difference based on fx = f(t, x).
+ */
+bool FMUWrapper::getStateJacobian(double t, const double* x, const double* fx, double* values)
+{
+  const size_t n = n_states;
+  std::vector<double> seed(n, 0.0);
+  std::vector<double> xp(x, x + n);
+  std::vector<double> dx(n);
+  std::vector<double> h(n);
+
+  fmi2_status_t fmistatus = fmi2_import_set_time(fmu, t);
+  if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_set_time failed");
+  fmistatus = fmi2_import_set_continuous_states(fmu, x, n);
+  if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_set_continuous_states failed");
+
+  const bool directional = providesDirectionalDerivatives();
+  for (size_t c = 0; c < jacobianColorGroups.size(); ++c)
+  {
+    const std::vector<int>& group = jacobianColorGroups[c];
+
+    if (directional)
+    {
+      for (size_t l = 0; l < group.size(); ++l)
+        seed[group[l]] = 1.0;
+      if (!getDirectionalDerivative(derivativeVRs.data(), n, stateVRs.data(), n, seed.data(), dx.data()))
+        return false;
+      for (size_t l = 0; l < group.size(); ++l)
+        seed[group[l]] = 0.0;
+    }
+    else
+    {
+      for (size_t l = 0; l < group.size(); ++l)
+      {
+        int j = group[l];
+        xp[j] = x[j] + 1e-8 * std::max(std::fabs(x[j]), std::fabs(states_nominal[j]));
+        h[j] = xp[j] - x[j];
+      }
+
+      fmistatus = fmi2_import_set_continuous_states(fmu, xp.data(), n);
+      if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_set_continuous_states failed");
+      fmistatus = fmi2_import_get_derivatives(fmu, dx.data(), n);
+      if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_get_derivatives failed");
+
+      for (size_t i = 0; i < n; ++i)
+        dx[i] -= fx[i];
+      for (size_t l = 0; l < group.size(); ++l)
+        xp[group[l]] = x[group[l]];
+    }
+
+    for (size_t l = 0; l < group.size(); ++l)
+    {
+      int j = group[l];
+      for (int k = jacobianColPtrs[j]; k < jacobianColPtrs[j+1]; ++k)
+        values[k] = directional ? dx[jacobianRowVals[k]] : dx[jacobianRowVals[k]] / h[j];
+    }
+  }
+
+  if (!directional)
+  {
+    fmistatus = fmi2_import_set_continuous_states(fmu, x, n);
+    if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_set_continuous_states failed");
+  }
+  return true;
+}
+
+/**
+ * Sensitivities of real variables with respect to the parameters given to
+ * setSensitivityParameters at the current time. The result is a row-major
+ * n x n_params matrix.
+ */
+bool FMUWrapper::getRealSensitivities(const fmi2_value_reference_t* vr, size_t n, double* result)
+{
+  logTrace();
+
+  const size_t np = sensitivityParameters.size();
+  if (np == 0 || sensitivities.size() != n_states * np)
+  {
+    logError("FMUWrapper::getRealSensitivities: Sensitivities aren't available for FMU '" + instanceName + "'");
+    return false;
+  }
+
+  // states are read directly, all other variables are computed from the state sensitivities
+  std::vector<fmi2_value_reference_t> unknowns;
+  std::vector<size_t> index;
+  for (size_t k = 0; k < n; ++k)
+  {
+    std::vector<fmi2_value_reference_t>::iterator it = std::find(stateVRs.begin(), stateVRs.end(), vr[k]);
+    if (it != stateVRs.end())
+    {
+      size_t i = it - stateVRs.begin();
+      for (size_t j = 0; j < np; ++j)
+        result[k*np + j] = sensitivities[j*n_states + i];
+    }
+    else
+    {
+      unknowns.push_back(vr[k]);
+      index.push_back(k);
+    }
+  }
+
+  if (unknowns.empty())
+    return true;
+
+  const double one = 1.0;
+  std::vector<double> dydx(unknowns.size());
+  std::vector<double> dydp(unknowns.size());
+  for (size_t j = 0; j < np; ++j)
+  {
+    if (!getDirectionalDerivative(unknowns.data(), unknowns.size(), stateVRs.data(), n_states, &sensitivities[j*n_states], dydx.data()))
+      return false;
+    if (!getDirectionalDerivative(unknowns.data(), unknowns.size(), &sensitivityParameters[j], 1, &one, dydp.data()))
+      return false;
+    for (size_t k = 0; k < index.size(); ++k)
+      result[index[k]*np + j] = dydx[k] + dydp[k];
+  }
+  return true;
+}
+
 void FMUWrapper::getDependencyGraph_outputs()
 {
   size_t *startIndex, *dependency;
@@ -678,18 +1157,21 @@ void FMUWrapper::getDependencyGraph_initialUnknowns()
 
 Variable* FMUWrapper::getVariable(const std::string& name)
 {
-  for (size_t i = 0; i < allVariables.size(); i++)
-    if (name == allVariables[i].getName())
-      return &allVariables[i];
-  return NULL;
+  auto it = nameIndex.find(name.c_str());
+  if (it == nameIndex.end())
+    return NULL;
+  return &allVariables[it->second];
 }
 
+/**
+ * Returns the first real variable with the given value reference.
+ */
 Variable* FMUWrapper::getVariable(const fmi2_value_reference_t& state_vr)
 {
-  for (size_t i = 0; i < allVariables.size(); i++)
-    if (state_vr == allVariables[i].getValueReference())
-      return &allVariables[i];
-  return NULL;
+  auto it = realVRIndex.find(state_vr);
+  if (it == realVRIndex.end())
+    return NULL;
+  return &allVariables[it->second];
 }
 
 std::string FMUWrapper::getFMUKind() const
@@ -706,6 +1188,13 @@ bool FMUWrapper::isFMUKindME() const
   return false;
 }
 
+bool FMUWrapper::providesDirectionalDerivatives() const
+{
+  if (fmi2_fmu_kind_me == fmuKind)
+    return fmi2_import_get_capability(fmu, fmi2_me_providesDirectionalDerivatives) != 0;
+  return fmi2_import_get_capability(fmu, fmi2_cs_providesDirectionalDerivatives) != 0;
+}
+
 std::string FMUWrapper::getGUID() const
 {
   const char* GUID = fmi2_import_get_GUID(fmu);
@@ -773,6 +1262,22 @@ void FMUWrapper::exitInitialization()
 
   if (fmi2_fmu_kind_me == fmuKind)
   {
+    sensitivities.clear();
+    if (!sensitivityParameters.empty())
+    {
+      if (CVODE != solverMethod)
+      {
+        logError("FMUWrapper::exitInitialization: Sensitivities need solver 'cvode' for FMU '" + instanceName + "'");
+        sensitivityParameters.clear();
+      }
+      else if (!getInitialSensitivities())
+      {
+        logError("FMUWrapper::exitInitialization: Couldn't compute the initial sensitivities of FMU '" + instanceName + "'");
+        sensitivityParameters.clear();
+        sensitivities.clear();
+      }
+    }
+
     fmistatus = fmi2_import_exit_initialization_mode(fmu);
     if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_exit_initialization_mode failed");
 
@@ -793,6 +1298,7 @@ void FMUWrapper::exitInitialization()
     fmi2_import_enter_continuous_time_mode(fmu);
 
     callEventUpdate = fmi2_false;
+    stateEvent = false;
 
     n_states = fmi2_import_get_number_of_continuous_states(fmu);
     n_event_indicators = fmi2_import_get_number_of_event_indicators(fmu);
@@ -822,6 +1328,8 @@ void FMUWrapper::exitInitialization()
     fmistatus = fmi2_import_get_event_indicators(fmu, event_indicators, n_event_indicators);
     if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_get_event_indicators failed");
 
+    completedIntegratorStepNotNeeded = fmi2_import_get_capability(fmu, fmi2_me_completedIntegratorStepNotNeeded) != 0;
+
     if (n_states < 1)
     {
       this->solverMethod = NO_SOLVER;
@@ -829,6 +1337,7 @@ void FMUWrapper::exitInitialization()
     }
 
     // initialize solver data
+    solverStatistics = oms_solver_statistics_t();
     if (NO_SOLVER == solverMethod)
     {
       if (n_states > 0)
@@ -837,17 +1346,28 @@ void FMUWrapper::exitInitialization()
     else if (EXPLICIT_EULER == solverMethod)
     {
     }
+    else if (RK4 == solverMethod || DOPRI5 == solverMethod)
+    {
+      // stages and the work vectors for the dense output
+      rkStages.assign(12 * n_states, 0.0);
+      rkStepSize = getSolverOption("initialStepSize", getCommunicationInterval() / 10);
+    }
     else if (CVODE == solverMethod)
     {
-      solverData.cvode.y = N_VNew_Serial(static_cast<long>(n_states));
+      // the sensitivities (if any) are appended to the states
+      const size_t N = n_states + sensitivities.size();
+
+      solverData.cvode.y = N_VNew_Serial(static_cast<long>(N));
       if (!solverData.cvode.y) logFatal("SUNDIALS_ERROR: N_VNew_Serial() failed - returned NULL pointer");
       for (size_t i = 0; i < n_states; ++i)
         NV_Ith_S(solverData.cvode.y, i) = states[i];
+      for (size_t i = 0; i < sensitivities.size(); ++i)
+        NV_Ith_S(solverData.cvode.y, n_states + i) = sensitivities[i];
 
-      solverData.cvode.abstol = N_VNew_Serial(static_cast<long>(n_states));
+      solverData.cvode.abstol = N_VNew_Serial(static_cast<long>(N));
       if (!solverData.cvode.abstol) logFatal("SUNDIALS_ERROR: N_VNew_Serial() failed - returned NULL pointer");
-      for (size_t i = 0; i < n_states; ++i)
-        NV_Ith_S(solverData.cvode.abstol, i) = 0.01*relativeTolerance*states_nominal[i];
+      for (size_t i = 0; i < N; ++i)
+        NV_Ith_S(solverData.cvode.abstol, i) = getSolverOption("absoluteToleranceFactor", 0.01)*relativeTolerance*states_nominal[i % n_states];
 
       // Call CVodeCreate to create the solver memory and specify the
       // Backward Differentiation Formula and the use of a Newton iteration
@@ -868,17 +1388,77 @@ void FMUWrapper::exitInitialization()
       flag = CVodeSVtolerances(solverData.cvode.mem, relativeTolerance, solverData.cvode.abstol);
       if (flag < 0) logFatal("SUNDIALS_ERROR: CVodeSVtolerances() failed with flag = " + std::to_string(flag));
 
-      // Call CVDense to specify the CVDENSE dense linear solver */
-      flag = CVDense(solverData.cvode.mem, static_cast<long>(n_states));
-      if (flag < 0) logFatal("SUNDIALS_ERROR: CVDense() failed with flag = " + std::to_string(flag));
+      // only the sparse and iterative solvers and the sensitivities use the
+      // pattern, the dense solver relies on the internal difference quotients
+      if (KLU == linearSolver || SPGMR == linearSolver || !sensitivities.empty())
+        getJacobianSparsity();
 
-      double max_h = (model.getSettings().GetStopTime() - model.getSettings().GetStartTime()) / 10.0;
+      if (KLU == linearSolver)
+      {
+#ifdef OMS_WITH_KLU
+        // Call CVKLU to specify the sparse direct linear solver; the pattern
+        // is repeated for each block of sensitivities
+        const int nnz = static_cast<int>(jacobianRowVals.size() * (N / n_states));
+#ifdef OMS_SUNDIALS_2_7
+        flag = CVKLU(solverData.cvode.mem, static_cast<int>(N), nnz, CSC_MAT);
+#else
+        flag = CVKLU(solverData.cvode.mem, static_cast<int>(N), nnz);
+#endif
+        if (flag < 0) logFatal("SUNDIALS_ERROR: CVKLU() failed with flag = " + std::to_string(flag));
+        flag = CVSlsSetSparseJacFn(solverData.cvode.mem, cvode_jac_sparse);
+        if (flag < 0) logFatal("SUNDIALS_ERROR: CVSlsSetSparseJacFn() failed with flag = " + std::to_string(flag));
+#endif
+      }
+      else if (SPGMR == linearSolver)
+      {
+        // Call CVSpgmr to specify the Krylov solver with a banded
+        // preconditioner of the bandwidth of the sparsity pattern
+        long int mu = 0, ml = 0;
+        for (size_t j = 0; j < n_states; ++j)
+        {
+          for (int k = jacobianColPtrs[j]; k < jacobianColPtrs[j+1]; ++k)
+          {
+            long int i = jacobianRowVals[k];
+            mu = std::max(mu, static_cast<long int>(j) - i);
+            ml = std::max(ml, i - static_cast<long int>(j));
+          }
+        }
+        logDebug("band preconditioner of '" + instanceName + "': mu = " + std::to_string(mu) + ", ml = " + std::to_string(ml));
+
+        flag = CVSpgmr(solverData.cvode.mem, PREC_LEFT, 0);
+        if (flag < 0) logFatal("SUNDIALS_ERROR: CVSpgmr() failed with flag = " + std::to_string(flag));
+        flag = CVBandPrecInit(solverData.cvode.mem, static_cast<long>(N), mu, ml);
+        if (flag < 0) logFatal("SUNDIALS_ERROR: CVBandPrecInit() failed with flag = " + std::to_string(flag));
+      }
+      else
+      {
+        // Call CVDense to specify the CVDENSE dense linear solver
+        flag = CVDense(solverData.cvode.mem, static_cast<long>(N));
+        if (flag < 0) logFatal("SUNDIALS_ERROR: CVDense() failed with flag = " + std::to_string(flag));
+
+        // the internal difference quotients of CVODE would perturb all
+        // n*(1+p) columns of the extended system, each of them evaluating the
+        // sensitivity equations
+        if (!sensitivities.empty())
+        {
+          flag = CVDlsSetDenseJacFn(solverData.cvode.mem, cvode_jac);
+          if (flag < 0) logFatal("SUNDIALS_ERROR: CVDlsSetDenseJacFn() failed with flag = " + std::to_string(flag));
+        }
+      }
+
+      if (n_event_indicators > 0)
+      {
+        flag = CVodeRootInit(solverData.cvode.mem, static_cast<int>(n_event_indicators), cvode_root);
+        if (flag < 0) logFatal("SUNDIALS_ERROR: CVodeRootInit() failed with flag = " + std::to_string(flag));
+      }
+
+      double max_h = getSolverOption("maximalStepSize", (model.getSettings().GetStopTime() - model.getSettings().GetStartTime()) / 10.0);
       logInfo("maximum step size for '" + instanceName + "': " + std::to_string(max_h));
       flag = CVodeSetMaxStep(solverData.cvode.mem, max_h);
       if (flag < 0) logFatal("SUNDIALS_ERROR: CVodeSetMaxStep() failed with flag = " + std::to_string(flag));
 
       // further settings from cpp runtime
-      flag = CVodeSetInitStep(solverData.cvode.mem, 1e-6);        // INITIAL STEPSIZE
+      flag = CVodeSetInitStep(solverData.cvode.mem, getSolverOption("initialStepSize", 1e-6)); // INITIAL STEPSIZE
       if (flag < 0) logFatal("SUNDIALS_ERROR: CVodeSetInitStep() failed with flag = " + std::to_string(flag));
       flag = CVodeSetMaxOrd(solverData.cvode.mem, 5);             // MAXIMUM ORDER
       if (flag < 0) logFatal("SUNDIALS_ERROR: CVodeSetMaxOrd() failed with flag = " + std::to_string(flag));
@@ -886,13 +1466,13 @@ void FMUWrapper::exitInitialization()
       if (flag < 0) logFatal("SUNDIALS_ERROR: CVodeSetMaxConvFails() failed with flag = " + std::to_string(flag));
       flag = CVodeSetStabLimDet(solverData.cvode.mem, TRUE);      // STABILITY DETECTION
       if (flag < 0) logFatal("SUNDIALS_ERROR: CVodeSetStabLimDet() failed with flag = " + std::to_string(flag));
-      flag = CVodeSetMinStep(solverData.cvode.mem, 1e-12);        // MINIMUM STEPSIZE
+      flag = CVodeSetMinStep(solverData.cvode.mem, getSolverOption("minimalStepSize", 1e-12)); // MINIMUM STEPSIZE
       if (flag < 0) logFatal("SUNDIALS_ERROR: CVodeSetMinStep() failed with flag = " + std::to_string(flag));
-      flag = CVodeSetMaxNonlinIters(solverData.cvode.mem, 5);     // MAXIMUM NUMBER OF ITERATIONS
+      flag = CVodeSetMaxNonlinIters(solverData.cvode.mem, static_cast<int>(getSolverOption("maxNonlinIters", 5))); // MAXIMUM NUMBER OF ITERATIONS
       if (flag < 0) logFatal("SUNDIALS_ERROR: CVodeSetMaxNonlinIters() failed with flag = " + std::to_string(flag));
       flag = CVodeSetMaxErrTestFails(solverData.cvode.mem, 100);  // MAXIMUM NUMBER OF ERROR TEST FAILURES
       if (flag < 0) logFatal("SUNDIALS_ERROR: CVodeSetMaxErrTestFails() failed with flag = " + std::to_string(flag));
-      flag = CVodeSetMaxNumSteps(solverData.cvode.mem, 1000);     // MAXIMUM NUMBER OF STEPS
+      flag = CVodeSetMaxNumSteps(solverData.cvode.mem, static_cast<long int>(getSolverOption("maxNumSteps", 1000))); // MAXIMUM NUMBER OF STEPS
       if (flag < 0) logFatal("SUNDIALS_ERROR: CVodeSetMaxNumSteps() failed with flag = " + std::to_string(flag));
     }
     else
@@ -921,27 +1501,23 @@ void FMUWrapper::terminate()
     else if (EXPLICIT_EULER == solverMethod)
     {
     }
+    else if (RK4 == solverMethod || DOPRI5 == solverMethod)
+    {
+      if (DOPRI5 == solverMethod)
+      {
+        logInfo("Final Statistics for '" + instanceName + "':");
+        logInfo("NumSteps = " + std::to_string(solverStatistics.numSteps) + " NumRhsEvals  = " + std::to_string(solverStatistics.numRhsEvals) + " NumErrTestFails = " + std::to_string(solverStatistics.numErrTestFails));
+      }
+      rkStages.clear();
+    }
     else if (CVODE == solverMethod)
     {
-      long int nst, nfe, nsetups, nni, ncfn, netf;
-      int flag;
-
-      flag = CVodeGetNumSteps(solverData.cvode.mem, &nst);
-      if (flag < 0) logFatal("SUNDIALS_ERROR: CVodeGetNumSteps() failed with flag = " + std::to_string(flag));
-      flag = CVodeGetNumRhsEvals(solverData.cvode.mem, &nfe);
-      if (flag < 0) logFatal("SUNDIALS_ERROR: CVodeGetNumRhsEvals() failed with flag = " + std::to_string(flag));
-      flag = CVodeGetNumLinSolvSetups(solverData.cvode.mem, &nsetups);
-      if (flag < 0) logFatal("SUNDIALS_ERROR: CVodeGetNumLinSolvSetups() failed with flag = " + std::to_string(flag));
-      flag = CVodeGetNumErrTestFails(solverData.cvode.mem, &netf);
-      if (flag < 0) logFatal("SUNDIALS_ERROR: CVodeGetNumErrTestFails() failed with flag = " + std::to_string(flag));
-      flag = CVodeGetNumNonlinSolvIters(solverData.cvode.mem, &nni);
-      if (flag < 0) logFatal("SUNDIALS_ERROR: CVodeGetNumNonlinSolvIters() failed with flag = " + std::to_string(flag));
-      flag = CVodeGetNumNonlinSolvConvFails(solverData.cvode.mem, &ncfn);
-      if (flag < 0) logFatal("SUNDIALS_ERROR: CVodeGetNumNonlinSolvConvFails() failed with flag = " + std::to_string(flag));
+      // keep the final statistics, they are still queried after terminate
+      updateSolverStatistics();
 
       logInfo("Final Statistics for '" + instanceName + "':");
-      logInfo("NumSteps = " + std::to_string(nst) + " NumRhsEvals  = " + std::to_string(nfe) + " NumLinSolvSetups = " + std::to_string(nsetups));
-      logInfo("NumNonlinSolvIters = " + std::to_string(nni) + " NumNonlinSolvConvFails = " + std::to_string(ncfn) + " NumErrTestFails = " + std::to_string(netf));
+      logInfo("NumSteps = " + std::to_string(solverStatistics.numSteps) + " NumRhsEvals  = " + std::to_string(solverStatistics.numRhsEvals) + " NumLinSolvSetups = " + std::to_string(solverStatistics.numLinSolvSetups));
+      logInfo("NumNonlinSolvIters = " + std::to_string(solverStatistics.numNonlinSolvIters) + " NumNonlinSolvConvFails = " + std::to_string(solverStatistics.numNonlinSolvConvFails) + " NumErrTestFails = " + std::to_string(solverStatistics.numErrTestFails));
 
       N_VDestroy_Serial(solverData.cvode.y);
       N_VDestroy_Serial(solverData.cvode.abstol);
@@ -971,6 +1547,10 @@ void FMUWrapper::reset()
     else if (EXPLICIT_EULER == solverMethod)
     {
     }
+    else if (RK4 == solverMethod || DOPRI5 == solverMethod)
+    {
+      rkStages.clear();
+    }
     else if (CVODE == solverMethod)
     {
       N_VDestroy_Serial(solverData.cvode.y);
@@ -993,7 +1573,7 @@ void FMUWrapper::doStep(double stopTime)
 {
   OMS_TIC(clocks, CLOCK_DO_STEP);
   fmi2_status_t fmistatus;
-  const fmi2_real_t hdef = model.getSettings().GetCommunicationInterval() / 10;
+  const fmi2_real_t hdef = getCommunicationInterval() / 10;
 
   if (fmi2_fmu_kind_me == fmuKind)
   {
@@ -1002,6 +1582,8 @@ void FMUWrapper::doStep(double stopTime)
     fmi2_real_t tlast = tcur;
     while ((tcur < stopTime) && (!(eventInfo.terminateSimulation || terminateSimulation)))
     {
+      bool stepCompleted = false;
+
       fmistatus = fmi2_import_set_time(fmu, tcur);
       if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_set_time failed");
 
@@ -1016,7 +1598,8 @@ void FMUWrapper::doStep(double stopTime)
       }
 
       // check if an event indicator has triggered
-      int zero_crossing_event = 0;
+      int zero_crossing_event = stateEvent ? 1 : 0;
+      stateEvent = false;
       for (int k = 0; k < n_event_indicators; k++)
       {
         if ((event_indicators[k] > 0) != (event_indicators_prev[k] > 0))
@@ -1057,9 +1640,10 @@ void FMUWrapper::doStep(double stopTime)
       }
       OMS_TOC(clocks, CLOCK_EVENTS);
 
-      // calculate next time step
+      // calculate next time step; CVODE and dopri5 integrate up to the
+      // communication point and stop at zero-crossings by themselves
       tlast = tcur;
-      tcur += hdef;
+      tcur = (CVODE == solverMethod || DOPRI5 == solverMethod) ? stopTime : tcur + hdef;
       if (eventInfo.nextEventTimeDefined && (tcur >= eventInfo.nextEventTime))
         tcur = eventInfo.nextEventTime;
 
@@ -1080,16 +1664,64 @@ void FMUWrapper::doStep(double stopTime)
       {
         for (int k = 0; k < n_states; k++)
           states[k] = states[k] + hcur*states_der[k];
+        solverStatistics.numSteps++;
+      }
+      else if (RK4 == solverMethod)
+      {
+        rk4Step(tlast, hcur);
+        solverStatistics.numSteps++;
+      }
+      else if (DOPRI5 == solverMethod)
+      {
+        tcur = dopri5(tlast, tcur);
+
+        // the stages may have left the FMU at another time
+        fmistatus = fmi2_import_set_time(fmu, tcur);
+        if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_set_time failed");
       }
       else if (CVODE == solverMethod)
       {
         double cvode_time = tlast;
-        while (cvode_time < tcur)
+        int flag = CVodeSetStopTime(solverData.cvode.mem, tcur);
+        if (flag < 0) logFatal("SUNDIALS_ERROR: CVodeSetStopTime() failed with flag = " + std::to_string(flag));
+        if (completedIntegratorStepNotNeeded)
         {
-          int flag = CVode(solverData.cvode.mem, tcur, solverData.cvode.y, &cvode_time, CV_ONE_STEP);
+          flag = CVode(solverData.cvode.mem, tcur, solverData.cvode.y, &cvode_time, CV_NORMAL);
           if (flag < 0) logFatal("SUNDIALS_ERROR: CVode() failed with flag = " + std::to_string(flag));
         }
+        else
+        {
+          // the FMU is notified about every internal step of CVODE and may
+          // request an event iteration after any of them
+          do
+          {
+            flag = CVode(solverData.cvode.mem, tcur, solverData.cvode.y, &cvode_time, CV_ONE_STEP);
+            if (flag < 0) logFatal("SUNDIALS_ERROR: CVode() failed with flag = " + std::to_string(flag));
+            if (CV_SUCCESS != flag)
+              break;
+
+            fmistatus = fmi2_import_set_time(fmu, cvode_time);
+            if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_set_time failed");
+            for (size_t i = 0; i < n_states; ++i)
+              states[i] = NV_Ith_S(solverData.cvode.y, i);
+            fmistatus = fmi2_import_set_continuous_states(fmu, states, n_states);
+            if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_set_continuous_states failed");
+            fmistatus = fmi2_import_completed_integrator_step(fmu, fmi2_true, &callEventUpdate, &terminateSimulation);
+            if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_completed_integrator_step failed");
+            stepCompleted = callEventUpdate || terminateSimulation;
+          } while (!stepCompleted);
+        }
+        stateEvent = (CV_ROOT_RETURN == flag);
         tcur = cvode_time;
+
+        // the root function and the rhs may have left the FMU at another time
+        fmistatus = fmi2_import_set_time(fmu, tcur);
+        if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_set_time failed");
+
+        for (size_t i = 0; i < n_states; ++i)
+          states[i] = NV_Ith_S(solverData.cvode.y, i);
+        for (size_t i = 0; i < sensitivities.size(); ++i)
+          sensitivities[i] = NV_Ith_S(solverData.cvode.y, n_states + i);
       }
       else
         logFatal("Unknown solver method");
@@ -1105,22 +1737,402 @@ void FMUWrapper::doStep(double stopTime)
       }
 
       // step is complete
-      fmistatus = fmi2_import_completed_integrator_step(fmu, fmi2_true, &callEventUpdate, &terminateSimulation);
-      if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_completed_integrator_step failed");
+      if (!completedIntegratorStepNotNeeded && !stepCompleted)
+      {
+        fmistatus = fmi2_import_completed_integrator_step(fmu, fmi2_true, &callEventUpdate, &terminateSimulation);
+        if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_completed_integrator_step failed");
+      }
     }
   }
   else if (fmi2_fmu_kind_cs == fmuKind || fmi2_fmu_kind_me_and_cs == fmuKind)
   {
+    // with an adaptive macro step the FMU covers it with a single step
+    const fmi2_real_t h = model.getSettings().GetAdaptiveStepSize() ? stopTime - tcur : hdef;
     while (tcur < stopTime)
     {
-      fmistatus = fmi2_import_do_step(fmu, tcur, hdef, fmi2_true);
-      tcur += hdef;
+      fmi2_real_t hcur = h;
+      if (tcur + hcur > stopTime - hcur / 1e16)
+        hcur = stopTime - tcur;
+      fmistatus = fmi2_import_do_step(fmu, tcur, hcur, fmi2_true);
+      tcur = (hcur == h) ? tcur + hcur : stopTime;
     }
   }
 
   OMS_TOC(clocks, CLOCK_DO_STEP);
 }
 
+void FMUWrapper::getDerivatives(double t, const double* x, double* dx)
+{
+  solverStatistics.numRhsEvals++;
+  fmi2_status_t fmistatus = fmi2_import_set_time(fmu, t);
+  if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_set_time failed");
+  fmistatus = fmi2_import_set_continuous_states(fmu, x, n_states);
+  if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_set_continuous_states failed");
+  fmistatus = fmi2_import_get_derivatives(fmu, dx, n_states);
+  if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_get_derivatives failed");
+}
+
+void FMUWrapper::getEventIndicators(double t, const double* x, double* z)
+{
+  fmi2_status_t fmistatus = fmi2_import_set_time(fmu, t);
+  if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_set_time failed");
+  fmistatus = fmi2_import_set_continuous_states(fmu, x, n_states);
+  if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_set_continuous_states failed");
+  fmistatus = fmi2_import_get_event_indicators(fmu, z, n_event_indicators);
+  if (fmi2_status_ok != fmistatus) logFatal("fmi2_import_get_event_indicators failed");
+}
+
+/**
+ * One step of the classical Runge-Kutta method. states_der holds the
+ * derivatives at (t, states).
+ */
+void FMUWrapper::rk4Step(double t, double h)
+{
+  const size_t n = n_states;
+  double* k2 = &rkStages[0];
+  double* k3 = &rkStages[n];
+  double* k4 = &rkStages[2*n];
+  double* x = &rkStages[3*n];
+
+  for (size_t i = 0; i < n; ++i)
+    x[i] = states[i] + 0.5*h*states_der[i];
+  getDerivatives(t + 0.5*h, x, k2);
+  for (size_t i = 0; i < n; ++i)
+    x[i] = states[i] + 0.5*h*k2[i];
+  getDerivatives(t + 0.5*h, x, k3);
+  for (size_t i = 0; i < n; ++i)
+    x[i] = states[i] + h*k3[i];
+  getDerivatives(t + h, x, k4);
+
+  for (size_t i = 0; i < n; ++i)
+    states[i] += h/6.0 * (states_der[i] + 2.0*k2[i] + 2.0*k3[i] + k4[i]);
+}
+
+/**
+ * Integrates from t towards tend with the embedded Dormand-Prince 5(4)
+ * method and error control based on the relative tolerance of the FMU.
+ * Zero-crossings of the event indicators are located on the continuous
+ * extension of the method (Hairer, Norsett, Wanner), in which case the
+ * integration stops right after the crossing and stateEvent is set.
+ *
+ * \return the time that was reached
+ */
+double FMUWrapper::dopri5(double t, double tend)
+{
+  static const double c2=1.0/5.0, c3=3.0/10.0, c4=4.0/5.0, c5=8.0/9.0;
+  static const double a21=1.0/5.0;
+  static const double a31=3.0/40.0, a32=9.0/40.0;
+  static const double a41=44.0/45.0, a42=-56.0/15.0, a43=32.0/9.0;
+  static const double a51=19372.0/6561.0, a52=-25360.0/2187.0, a53=64448.0/6561.0, a54=-212.0/729.0;
+  static const double a61=9017.0/3168.0, a62=-355.0/33.0, a63=46732.0/5247.0, a64=49.0/176.0, a65=-5103.0/18656.0;
+  static const double a71=35.0/384.0, a73=500.0/1113.0, a74=125.0/192.0, a75=-2187.0/6784.0, a76=11.0/84.0;
+  static const double e1=71.0/57600.0, e3=-71.0/16695.0, e4=71.0/1920.0, e5=-17253.0/339200.0, e6=22.0/525.0, e7=-1.0/40.0;
+  static const double d1=-12715105075.0/11282082432.0, d3=87487479700.0/32700410799.0, d4=-10690763975.0/1880347072.0;
+  static const double d5=701980252875.0/199316789632.0, d6=-1453857185.0/822651844.0, d7=69997945.0/29380423.0;
+
+  const size_t n = n_states;
+  double* k1 = &rkStages[0];
+  double* k2 = &rkStages[n];
+  double* k3 = &rkStages[2*n];
+  double* k4 = &rkStages[3*n];
+  double* k5 = &rkStages[4*n];
+  double* k6 = &rkStages[5*n];
+  double* k7 = &rkStages[6*n];
+  double* x = &rkStages[7*n];
+  double* x1 = &rkStages[8*n];
+  double* r3 = &rkStages[9*n];
+  double* r4 = &rkStages[10*n];
+  double* r5 = &rkStages[11*n];
+
+  const double rtol = relativeTolerance;
+  std::vector<double> z0(event_indicators, event_indicators + n_event_indicators);
+  std::vector<double> z1(n_event_indicators);
+
+  getDerivatives(t, states, k1);
+  while (t < tend)
+  {
+    double h = std::min(rkStepSize, tend - t);
+    bool last = (t + h >= tend - 1e-14 * std::fabs(tend));
+    if (last)
+      h = tend - t;
+
+    for (size_t i = 0; i < n; ++i) x[i] = states[i] + h*a21*k1[i];
+    getDerivatives(t + c2*h, x, k2);
+    for (size_t i = 0; i < n; ++i) x[i] = states[i] + h*(a31*k1[i] + a32*k2[i]);
+    getDerivatives(t + c3*h, x, k3);
+    for (size_t i = 0; i < n; ++i) x[i] = states[i] + h*(a41*k1[i] + a42*k2[i] + a43*k3[i]);
+    getDerivatives(t + c4*h, x, k4);
+    for (size_t i = 0; i < n; ++i) x[i] = states[i] + h*(a51*k1[i] + a52*k2[i] + a53*k3[i] + a54*k4[i]);
+    getDerivatives(t + c5*h, x, k5);
+    for (size_t i = 0; i < n; ++i) x[i] = states[i] + h*(a61*k1[i] + a62*k2[i] + a63*k3[i] + a64*k4[i] + a65*k5[i]);
+    getDerivatives(t + h, x, k6);
+    for (size_t i = 0; i < n; ++i) x1[i] = states[i] + h*(a71*k1[i] + a73*k3[i] + a74*k4[i] + a75*k5[i] + a76*k6[i]);
+    getDerivatives(t + h, x1, k7);
+
+    // error estimate of the embedded 4th order solution
+    double err = 0.0;
+    for (size_t i = 0; i < n; ++i)
+    {
+      double sc = 0.01*rtol*states_nominal[i] + rtol*std::max(std::fabs(states[i]), std::fabs(x1[i]));
+      double e = h*(e1*k1[i] + e3*k3[i] + e4*k4[i] + e5*k5[i] + e6*k6[i] + e7*k7[i]) / sc;
+      err += e*e;
+    }
+    err = n > 0 ? std::sqrt(err / n) : 0.0;
+
+    double fac = err > 0.0 ? 0.9 * std::pow(err, -0.2) : 5.0;
+    fac = std::min(5.0, std::max(0.2, fac));
+    if (err > 1.0 && h > 1e-12)
+    {
+      solverStatistics.numErrTestFails++;
+      rkStepSize = h * fac;
+      continue;
+    }
+    solverStatistics.numSteps++;
+    if (!last)
+      rkStepSize = h * fac;
+
+    // continuous extension: x(t+theta*h) = states + theta*(x1-states + (1-theta)*(r3 + theta*(r4 + (1-theta)*r5)))
+    for (size_t i = 0; i < n; ++i)
+    {
+      double ydiff = x1[i] - states[i];
+      r3[i] = h*k1[i] - ydiff;
+      r4[i] = ydiff - h*k7[i] - r3[i];
+      r5[i] = h*(d1*k1[i] + d3*k3[i] + d4*k4[i] + d5*k5[i] + d6*k6[i] + d7*k7[i]);
+    }
+
+    bool crossing = false;
+    if (n_event_indicators > 0)
+    {
+      getEventIndicators(t + h, x1, z1.data());
+      for (size_t k = 0; k < n_event_indicators && !crossing; ++k)
+        crossing = (z0[k] > 0) != (z1[k] > 0);
+    }
+
+    if (crossing)
+    {
+      // bisection for the first crossing of any indicator
+      double left = 0.0, right = 1.0;
+      while ((right - left) * h > 1e-12 * std::max(1.0, std::fabs(t)))
+      {
+        double theta = 0.5*(left + right);
+        double theta1 = 1.0 - theta;
+        for (size_t i = 0; i < n; ++i)
+          x[i] = states[i] + theta*((x1[i] - states[i]) + theta1*(r3[i] + theta*(r4[i] + theta1*r5[i])));
+        getEventIndicators(t + theta*h, x, z1.data());
+
+        bool found = false;
+        for (size_t k = 0; k < n_event_indicators && !found; ++k)
+          found = (z0[k] > 0) != (z1[k] > 0);
+        if (found)
+          right = theta;
+        else
+          left = theta;
+      }
+
+      double theta1 = 1.0 - right;
+      for (size_t i = 0; i < n; ++i)
+        states[i] += right*((x1[i] - states[i]) + theta1*(r3[i] + right*(r4[i] + theta1*r5[i])));
+      stateEvent = true;
+      return t + right*h;
+    }
+
+    // FSAL: the last stage is the first stage of the next step
+    std::copy(x1, x1 + n, states);
+    std::copy(k7, k7 + n, k1);
+    std::copy(z1.begin(), z1.end(), z0.begin());
+    t = last ? tend : t + h;
+  }
+
+  return t;
+}
+
+bool FMUWrapper::canGetAndSetState() const
+{
+  if (fmi2_fmu_kind_me == fmuKind)
+    return fmi2_import_get_capability(fmu, fmi2_me_canGetAndSetFMUstate) != 0;
+  return fmi2_import_get_capability(fmu, fmi2_cs_canGetAndSetFMUstate) != 0;
+}
+
+bool FMUWrapper::canSerializeState() const
+{
+  if (fmi2_fmu_kind_me == fmuKind)
+    return fmi2_import_get_capability(fmu, fmi2_me_canSerializeFMUstate) != 0;
+  return fmi2_import_get_capability(fmu, fmi2_cs_canSerializeFMUstate) != 0;
+}
+
+FMUWrapper::State* FMUWrapper::saveState()
+{
+  logTrace();
+
+  if (!canGetAndSetState())
+  {
+    logError("FMUWrapper::saveState: FMU '" + instanceName + "' can't get and set its state");
+    return NULL;
+  }
+
+  State* state = new State();
+  state->fmuState = NULL;
+  fmi2_status_t fmistatus = fmi2_import_get_fmu_state(fmu, &state->fmuState);
+  if (fmi2_status_ok != fmistatus)
+  {
+    logError("FMUWrapper::saveState: fmi2_import_get_fmu_state failed for FMU '" + instanceName + "'");
+    delete state;
+    return NULL;
+  }
+
+  state->tcur = tcur;
+  state->eventInfo = eventInfo;
+  if (fmi2_fmu_kind_me == fmuKind)
+  {
+    state->callEventUpdate = callEventUpdate;
+    state->terminateSimulation = terminateSimulation;
+    state->states.assign(states, states + n_states);
+    state->states_der.assign(states_der, states_der + n_states);
+    state->event_indicators.assign(event_indicators, event_indicators + n_event_indicators);
+    state->event_indicators_prev.assign(event_indicators_prev, event_indicators_prev + n_event_indicators);
+    state->sensitivities = sensitivities;
+  }
+  return state;
+}
+
+/**
+ * Restores a state of saveState. CVODE doesn't provide access to its
+ * history, hence it is re-initialized at the restored time and states,
+ * i.e., it starts again with order one.
+ */
+bool FMUWrapper::restoreState(const State* state)
+{
+  logTrace();
+
+  if (fmi2_fmu_kind_me == fmuKind && (state->states.size() != n_states || state->event_indicators.size() != n_event_indicators || state->sensitivities.size() != sensitivities.size()))
+  {
+    logError("FMUWrapper::restoreState: Snapshot doesn't match FMU '" + instanceName + "'");
+    return false;
+  }
+
+  fmi2_status_t fmistatus = fmi2_import_set_fmu_state(fmu, state->fmuState);
+  if (fmi2_status_ok != fmistatus)
+  {
+    logError("FMUWrapper::restoreState: fmi2_import_set_fmu_state failed for FMU '" + instanceName + "'");
+    return false;
+  }
+
+  tcur = state->tcur;
+  eventInfo = state->eventInfo;
+  if (fmi2_fmu_kind_me == fmuKind)
+  {
+    callEventUpdate = state->callEventUpdate;
+    stateEvent = false;
+    terminateSimulation = state->terminateSimulation;
+    std::copy(state->states.begin(), state->states.end(), states);
+    std::copy(state->states_der.begin(), state->states_der.end(), states_der);
+    std::copy(state->event_indicators.begin(), state->event_indicators.end(), event_indicators);
+    std::copy(state->event_indicators_prev.begin(), state->event_indicators_prev.end(), event_indicators_prev);
+    sensitivities = state->sensitivities;
+
+    if (CVODE == solverMethod)
+    {
+      for (size_t i = 0; i < n_states; ++i)
+        NV_Ith_S(solverData.cvode.y, i) = states[i];
+      for (size_t i = 0; i < sensitivities.size(); ++i)
+        NV_Ith_S(solverData.cvode.y, n_states + i) = sensitivities[i];
+      int flag = CVodeReInit(solverData.cvode.mem, tcur, solverData.cvode.y);
+      if (flag < 0) logFatal("SUNDIALS_ERROR: CVodeReInit() failed with flag = " + std::to_string(flag));
+    }
+  }
+  return true;
+}
+
+void FMUWrapper::freeState(State* state)
+{
+  logTrace();
+
+  if (!state)
+    return;
+
+  fmi2_import_free_fmu_state(fmu, &state->fmuState);
+  delete state;
+}
+
+bool FMUWrapper::writeState(const State* state, std::ostream& stream)
+{
+  logTrace();
+
+  if (!canSerializeState())
+  {
+    logError("FMUWrapper::writeState: FMU '" + instanceName + "' can't serialize its state");
+    return false;
+  }
+
+  size_t size = 0;
+  fmi2_status_t fmistatus = fmi2_import_serialized_fmu_state_size(fmu, state->fmuState, &size);
+  if (fmi2_status_ok != fmistatus)
+  {
+    logError("FMUWrapper::writeState: fmi2_import_serialized_fmu_state_size failed for FMU '" + instanceName + "'");
+    return false;
+  }
+
+  std::vector<fmi2_byte_t> serializedState(size);
+  fmistatus = fmi2_import_serialize_fmu_state(fmu, state->fmuState, serializedState.data(), size);
+  if (fmi2_status_ok != fmistatus)
+  {
+    logError("FMUWrapper::writeState: fmi2_import_serialize_fmu_state failed for FMU '" + instanceName + "'");
+    return false;
+  }
+
+  writeBinary(stream, state->tcur);
+  writeBinary(stream, state->eventInfo);
+  writeBinary(stream, state->callEventUpdate);
+  writeBinary(stream, state->terminateSimulation);
+  writeBinary(stream, state->states);
+  writeBinary(stream, state->states_der);
+  writeBinary(stream, state->event_indicators);
+  writeBinary(stream, state->event_indicators_prev);
+  writeBinary(stream, state->sensitivities);
+  writeBinary(stream, serializedState);
+  return static_cast<bool>(stream);
+}
+
+FMUWrapper::State* FMUWrapper::readState(std::istream& stream)
+{
+  logTrace();
+
+  if (!canSerializeState())
+  {
+    logError("FMUWrapper::readState: FMU '" + instanceName + "' can't deserialize its state");
+    return NULL;
+  }
+
+  State* state = new State();
+  state->fmuState = NULL;
+  std::vector<fmi2_byte_t> serializedState;
+  bool ok = readBinary(stream, state->tcur)
+         && readBinary(stream, state->eventInfo)
+         && readBinary(stream, state->callEventUpdate)
+         && readBinary(stream, state->terminateSimulation)
+         && readBinary(stream, state->states)
+         && readBinary(stream, state->states_der)
+         && readBinary(stream, state->event_indicators)
+         && readBinary(stream, state->event_indicators_prev)
+         && readBinary(stream, state->sensitivities)
+         && readBinary(stream, serializedState);
+  if (!ok)
+  {
+    logError("FMUWrapper::readState: Corrupted snapshot for FMU '" + instanceName + "'");
+    delete state;
+    return NULL;
+  }
+
+  fmi2_status_t fmistatus = fmi2_import_de_serialize_fmu_state(fmu, serializedState.data(), serializedState.size(), &state->fmuState);
+  if (fmi2_status_ok != fmistatus)
+  {
+    logError("FMUWrapper::readState: fmi2_import_de_serialize_fmu_state failed for FMU '" + instanceName + "'");
+    delete state;
+    return NULL;
+  }
+  return state;
+}
+
 void FMUWrapper::SetSolverMethod(const std::string& solverMethod)
 {
   if (!isFMUKindME())
@@ -1135,10 +2147,129 @@ void FMUWrapper::SetSolverMethod(const std::string& solverMethod)
     this->solverMethod = EXPLICIT_EULER;
   else if (solverMethod == "cvode")
     this->solverMethod = CVODE;
+  else if (solverMethod == "rk4")
+    this->solverMethod = RK4;
+  else if (solverMethod == "dopri5")
+    this->solverMethod = DOPRI5;
   else
     logError("Settings::SetSolverMethod: Unknown solver method '" + solverMethod + "'");
 }
 
+void FMUWrapper::SetLinearSolver(const std::string& linearSolver)
+{
+  if (!isFMUKindME())
+  {
+    logError("FMUWrapper::SetLinearSolver: Linear solver can only be specified for FMU ME");
+    return;
+  }
+
+  if (linearSolver == "dense")
+    this->linearSolver = DENSE;
+  else if (linearSolver == "klu")
+  {
+#ifdef OMS_WITH_KLU
+    this->linearSolver = KLU;
+#else
+    logError("FMUWrapper::SetLinearSolver: OMSimulator is built without KLU support");
+#endif
+  }
+  else if (linearSolver == "spgmr")
+    this->linearSolver = SPGMR;
+  else
+    logError("FMUWrapper::SetLinearSolver: Unknown linear solver '" + linearSolver + "'");
+}
+
+std::string FMUWrapper::GetLinearSolverString() const
+{
+  switch (linearSolver)
+  {
+  case DENSE:
+    return std::string("dense");
+  case KLU:
+    return std::string("klu");
+  case SPGMR:
+    return std::string("spgmr");
+  default:
+    logError("FMUWrapper::GetLinearSolverString: Unknown linear solver " + std::to_string(linearSolver));
+    return std::string("unknown");
+  }
+}
+
+bool FMUWrapper::isSolverOption(const std::string& option)
+{
+  return option == "maxNumSteps" ||
+         option == "maxNonlinIters" ||
+         option == "initialStepSize" ||
+         option == "minimalStepSize" ||
+         option == "maximalStepSize" ||
+         option == "absoluteToleranceFactor";
+}
+
+bool FMUWrapper::setSolverOption(const std::string& option, double value)
+{
+  if (!isSolverOption(option))
+  {
+    logError("FMUWrapper::setSolverOption: Unknown solver option \"" + option + "\"");
+    return false;
+  }
+
+  if (value <= 0.0)
+  {
+    logError("FMUWrapper::setSolverOption: Invalid value " + std::to_string(value) + " for solver option \"" + option + "\"");
+    return false;
+  }
+
+  if ((option == "maxNumSteps" || option == "maxNonlinIters") && value != std::floor(value))
+  {
+    logError("FMUWrapper::setSolverOption: Solver option \"" + option + "\" expects an integer value");
+    return false;
+  }
+
+  solverOptions[option] = value;
+  return true;
+}
+
+double FMUWrapper::getSolverOption(const std::string& option, double defaultValue) const
+{
+  std::map<std::string, double>::const_iterator it = solverOptions.find(option);
+  if (it == solverOptions.end())
+    return defaultValue;
+  return it->second;
+}
+
+void FMUWrapper::updateSolverStatistics()
+{
+  if (CVODE != solverMethod || !solverData.cvode.mem)
+    return;
+
+  int flag;
+  flag = CVodeGetNumSteps(solverData.cvode.mem, &solverStatistics.numSteps);
+  if (flag < 0) logFatal("SUNDIALS_ERROR: CVodeGetNumSteps() failed with flag = " + std::to_string(flag));
+  flag = CVodeGetNumRhsEvals(solverData.cvode.mem, &solverStatistics.numRhsEvals);
+  if (flag < 0) logFatal("SUNDIALS_ERROR: CVodeGetNumRhsEvals() failed with flag = " + std::to_string(flag));
+  flag = CVodeGetNumLinSolvSetups(solverData.cvode.mem, &solverStatistics.numLinSolvSetups);
+  if (flag < 0) logFatal("SUNDIALS_ERROR: CVodeGetNumLinSolvSetups() failed with flag = " + std::to_string(flag));
+  flag = CVodeGetNumErrTestFails(solverData.cvode.mem, &solverStatistics.numErrTestFails);
+  if (flag < 0) logFatal("SUNDIALS_ERROR: CVodeGetNumErrTestFails() failed with flag = " + std::to_string(flag));
+  flag = CVodeGetNumNonlinSolvIters(solverData.cvode.mem, &solverStatistics.numNonlinSolvIters);
+  if (flag < 0) logFatal("SUNDIALS_ERROR: CVodeGetNumNonlinSolvIters() failed with flag = " + std::to_string(flag));
+  flag = CVodeGetNumNonlinSolvConvFails(solverData.cvode.mem, &solverStatistics.numNonlinSolvConvFails);
+  if (flag < 0) logFatal("SUNDIALS_ERROR: CVodeGetNumNonlinSolvConvFails() failed with flag = " + std::to_string(flag));
+}
+
+void FMUWrapper::getSolverStatistics(oms_solver_statistics_t* statistics)
+{
+  updateSolverStatistics();
+  *statistics = solverStatistics;
+}
+
+double FMUWrapper::getCommunicationInterval() const
+{
+  if (hasCommunicationInterval())
+    return communicationInterval;
+  return model.getSettings().GetCommunicationInterval();
+}
+
 std::string FMUWrapper::GetSolverMethodString() const
 {
   switch (solverMethod)
@@ -1149,6 +2280,10 @@ std::string FMUWrapper::GetSolverMethodString() const
     return std::string("euler");
   case CVODE:
     return std::string("cvode");
+  case RK4:
+    return std::string("rk4");
+  case DOPRI5:
+    return std::string("dopri5");
   default:
     logError("FMUWrapper::GetSolverMethodString: Unknown solver method " + std::to_string(solverMethod));
     return std::string("unknown");
@@ -1161,6 +2296,12 @@ void FMUWrapper::registerSignalsForResultFile(ResultWriter *resultFile)
 
   std::regex exp(variableFilter);
 
+  // signals are registered per type and sorted by value reference, so that
+  // they end up in contiguous columns of the result file
+  std::vector< std::pair<fmi2_value_reference_t, unsigned int> > reals;
+  std::vector< std::pair<fmi2_value_reference_t, unsigned int> > ints;
+  std::vector< std::pair<fmi2_value_reference_t, unsigned int> > bools;
+
   for (int i=0; i<allVariables.size(); ++i)
   {
     Variable& var = allVariables[i];
@@ -1176,38 +2317,73 @@ void FMUWrapper::registerSignalsForResultFile(ResultWriter *resultFile)
           value.realValue = getReal(var);
           resultFile->addParameter(name, description, SignalType_REAL, value);
         }
-      }
-      else
-      {
-        std::string name = var.getFMUInstanceName() + "." + var.getName();
-        const std::string& description = var.getDescription();
-        if (var.isTypeReal())
+        else if (var.isTypeInteger())
         {
-          unsigned int ID = resultFile->addSignal(name, description, SignalType_REAL);
-          resultFileMapping[ID] = i;
+          value.intValue = getInteger(var);
+          resultFile->addParameter(name, description, SignalType_INT, value);
+        }
+        else if (var.isTypeBoolean())
+        {
+          value.boolValue = getBoolean(var);
+          resultFile->addParameter(name, description, SignalType_BOOL, value);
         }
       }
+      else if (var.isTypeReal())
+        reals.push_back(std::make_pair(var.getValueReference(), i));
+      else if (var.isTypeInteger())
+        ints.push_back(std::make_pair(var.getValueReference(), i));
+      else if (var.isTypeBoolean())
+        bools.push_back(std::make_pair(var.getValueReference(), i));
     }
   }
 
+  std::sort(reals.begin(), reals.end());
+  std::sort(ints.begin(), ints.end());
+  std::sort(bools.begin(), bools.end());
+
+  registerSignals(resultFile, reals, SignalType_REAL, realSignals);
+  registerSignals(resultFile, ints, SignalType_INT, intSignals);
+  registerSignals(resultFile, bools, SignalType_BOOL, boolSignals);
+  boolSignalValues.resize(boolSignals.vr.size());
+
   OMS_TOC(globalClocks, GLOBALCLOCK_RESULTFILE);
 }
 
+void FMUWrapper::registerSignals(ResultWriter *resultFile, const std::vector< std::pair<fmi2_value_reference_t, unsigned int> >& variables, SignalType_t type, ResultFileSignals_t& signals)
+{
+  signals.vr.clear();
+  signals.firstID = 0;
+
+  for (int i=0; i<variables.size(); ++i)
+  {
+    const Variable& var = allVariables[variables[i].second];
+    std::string name = var.getFMUInstanceName() + "." + var.getName();
+    unsigned int ID = resultFile->addSignal(name, var.getDescription(), type);
+    if (0 == i)
+      signals.firstID = ID;
+    signals.vr.push_back(variables[i].first);
+  }
+}
+
 void FMUWrapper::updateSignalsForResultFile(ResultWriter *resultFile)
 {
   OMS_TIC(globalClocks, GLOBALCLOCK_RESULTFILE);
 
-  for (auto it=resultFileMapping.begin(); it != resultFileMapping.end(); it++)
+  // one fmi2Get call per type, straight into the row buffer of the result file
+  double* realBuffer = realSignals.vr.empty() ? NULL : resultFile->getRealBuffer(realSignals.firstID);
+  if (realBuffer)
+    fmi2_import_get_real(fmu, &realSignals.vr[0], realSignals.vr.size(), realBuffer);
+
+  int32_t* intBuffer = intSignals.vr.empty() ? NULL : resultFile->getIntegerBuffer(intSignals.firstID);
+  if (intBuffer)
+    fmi2_import_get_integer(fmu, &intSignals.vr[0], intSignals.vr.size(), intBuffer);
+
+  uint8_t* boolBuffer = boolSignals.vr.empty() ? NULL : resultFile->getBooleanBuffer(boolSignals.firstID);
+  if (boolBuffer)
   {
-    unsigned int ID = it->first;
-    unsigned int index = it->second;
-    Variable& var = allVariables[index];
-    SignalValue_t value;
-    if (var.isTypeReal())
-    {
-      value.realValue = getReal(var);
-      resultFile->updateSignal(ID, value);
-    }
+    fmi2_import_get_boolean(fmu, &boolSignals.vr[0], boolSignals.vr.size(), &boolSignalValues[0]);
+    for (int i=0; i<boolSignalValues.size(); ++i)
+      boolBuffer[i] = boolSignalValues[i] ? 1 : 0;
   }
 
   OMS_TOC(globalClocks, GLOBALCLOCK_RESULTFILE);
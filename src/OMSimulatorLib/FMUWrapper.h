@@ -36,20 +36,43 @@
 #include "DirectedGraph.h"
 #include "Clocks.h"
 #include "ResultWriter.h"
+#include "Util.h"
+#include "Types.h"
 
 #include <fmilib.h>
 #include <string>
 #include <vector>
 #include <map>
 #include <unordered_map>
+#include <iostream>
 
 #include "cvode/cvode.h"             /* prototypes for CVODE fcts., consts. */
 #include "nvector/nvector_serial.h"  /* serial N_Vector types, fcts., macros */
+#include "sundials/sundials_dense.h" /* definitions DlsMat DENSE_ELEM */
+#ifdef OMS_WITH_KLU
+#include "sundials/sundials_sparse.h" /* definitions SlsMat */
+#endif
 
 class CompositeModel;
 
 class FMUWrapper
 {
+public:
+  /// snapshot of an FMU instance including the data of the master
+  struct State
+  {
+    fmi2_FMU_state_t fmuState;
+    fmi2_real_t tcur;
+    fmi2_event_info_t eventInfo;
+    fmi2_boolean_t callEventUpdate;
+    fmi2_boolean_t terminateSimulation;
+    std::vector<double> states;
+    std::vector<double> states_der;
+    std::vector<double> event_indicators;
+    std::vector<double> event_indicators_prev;
+    std::vector<double> sensitivities;
+  };
+
 public:
   FMUWrapper(CompositeModel& model, std::string fmuPath, std::string instanceName);
   ~FMUWrapper();
@@ -60,22 +83,38 @@ public:
   int getInteger(const Variable& var);
   bool getBoolean(const std::string& var);
   bool getBoolean(const Variable& var);
+  bool getReals(const fmi2_value_reference_t* vr, size_t n, double* values);
   bool setRealInput(const std::string& var, double value);
   bool setRealInput(const Variable& var, double value);
+  bool setRealInputs(const fmi2_value_reference_t* vr, size_t n, const double* values);
   bool setIntegerInput(const std::string& var, int value);
   bool setIntegerInput(const Variable& var, int value);
   bool setBooleanInput(const std::string& var, bool value);
   bool setBooleanInput(const Variable& var, bool value);
   bool setRealParameter(const std::string& var, double value);
+  bool setRealParameter(const Variable& var, double value);
   bool setIntegerParameter(const std::string& var, int value);
   bool setBooleanParameter(const std::string& var, bool value);
 
+  bool getDirectionalDerivative(const fmi2_value_reference_t* unknowns, size_t nUnknowns, const fmi2_value_reference_t* knowns, size_t nKnowns, const double* seed, double* result);
+
+  bool setSensitivityParameters(const std::vector<fmi2_value_reference_t>& parameters);
+  bool getRealSensitivities(const fmi2_value_reference_t* vr, size_t n, double* sensitivities);
+
   void enterInitialization(double startTime);
   void exitInitialization();
   void terminate();
   void reset();
   void doStep(double stopTime);
 
+  bool canGetAndSetState() const;
+  bool canSerializeState() const;
+  State* saveState();
+  bool restoreState(const State* state);
+  void freeState(State* state);
+  bool writeState(const State* state, std::ostream& stream);
+  State* readState(std::istream& stream);
+
   const DirectedGraph& getOutputsGraph() const {return outputsGraph;}
   const DirectedGraph& getInitialUnknownsGraph() const {return initialUnknownsGraph;}
   Variable* getVariable(const std::string& varName);
@@ -85,13 +124,28 @@ public:
   const std::string& getFMUInstanceName() const {return instanceName;}
   std::string getFMUKind() const;
   bool isFMUKindME() const;
+  bool providesDirectionalDerivatives() const;
   std::string getGUID() const;
   std::string getGenerationTool() const;
 
   void SetSolverMethod(const std::string& solverMethod);
   std::string GetSolverMethodString() const;
+  void SetLinearSolver(const std::string& linearSolver);
+  std::string GetLinearSolverString() const;
+  static bool isSolverOption(const std::string& option);
+  bool setSolverOption(const std::string& option, double value);
+  const std::map<std::string, double>& getSolverOptions() const {return solverOptions;}
+  void getSolverStatistics(oms_solver_statistics_t* statistics);
+
+  void setCommunicationInterval(double communicationInterval) {this->communicationInterval = communicationInterval;}
+  double getCommunicationInterval() const;
+  bool hasCommunicationInterval() const {return communicationInterval > 0.0;}
+  double getTime() const {return tcur;}
+  void setHoldInputs(bool holdInputs) {this->holdInputs = holdInputs;}
+  bool getHoldInputs() const {return holdInputs;}
 
   std::vector<Variable>& getAllVariables() {return allVariables;}
+  const std::vector<std::string>& getVariableNames() const {return variableNames;}
   std::vector<unsigned int>& getAllInputs() {return allInputs;}
   std::vector<unsigned int>& getAllOutputs() {return allOutputs;}
 
@@ -100,7 +154,8 @@ public:
 
   void setVariableFilter(const char* variableFilter) {this->variableFilter = variableFilter;}
 private:
-  enum Solver_t { NO_SOLVER, EXPLICIT_EULER, CVODE };
+  enum Solver_t { NO_SOLVER, EXPLICIT_EULER, CVODE, RK4, DOPRI5 };
+  enum LinearSolver_t { DENSE, KLU, SPGMR };
 
   struct SolverDataEuler_t
   {
@@ -120,12 +175,35 @@ private:
     SolverDataCVODE_t cvode;
   };
 
+  /// signals of one type that are stored in contiguous columns of the result file
+  struct ResultFileSignals_t
+  {
+    std::vector<fmi2_value_reference_t> vr;
+    unsigned int firstID;
+  };
+
 private:
   void do_event_iteration();
   void getDependencyGraph_outputs();
   void getDependencyGraph_initialUnknowns();
+  void registerSignals(ResultWriter *resultFile, const std::vector< std::pair<fmi2_value_reference_t, unsigned int> >& variables, SignalType_t type, ResultFileSignals_t& signals);
+  bool getInitialSensitivities();
+  bool getSensitivityDerivatives(const double* S, double* dS);
+  void getJacobianSparsity();
+  void getDerivatives(double t, const double* x, double* dx);
+  void getEventIndicators(double t, const double* x, double* z);
+  void rk4Step(double t, double h);
+  double dopri5(double t, double tend);
+  bool getStateJacobian(double t, const double* x, const double* fx, double* values);
+  double getSolverOption(const std::string& option, double defaultValue) const;
+  void updateSolverStatistics();
 
   friend int cvode_rhs(realtype t, N_Vector y, N_Vector ydot, void *user_data);
+  friend int cvode_root(realtype t, N_Vector y, realtype *gout, void *user_data);
+  friend int cvode_jac(long int N, realtype t, N_Vector y, N_Vector fy, DlsMat Jac, void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3);
+#ifdef OMS_WITH_KLU
+  friend int cvode_jac_sparse(realtype t, N_Vector y, N_Vector fy, SlsMat Jac, void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3);
+#endif
 
 private:
   CompositeModel& model;
@@ -141,6 +219,7 @@ private:
   fmi2_import_t* fmu;
   fmi2_event_info_t eventInfo;
 
+  std::vector<std::string> variableNames; ///< names of allVariables, in the same order
   std::vector<Variable> allVariables;
   std::vector<unsigned int> realVariables;
   std::vector<unsigned int> intVariables;
@@ -151,8 +230,17 @@ private:
   std::vector<unsigned int> allOutputs;
   std::vector<unsigned int> allParameters;
   std::vector<unsigned int> initialUnknowns;
+  std::vector<fmi2_value_reference_t> stateVRs;      ///< in the order of the continuous-state vector
+  std::vector<fmi2_value_reference_t> derivativeVRs; ///< in the order of the continuous-state vector
 
-  std::unordered_map<unsigned int /*result file var ID*/, unsigned int /*allVariables ID*/> resultFileMapping;
+  // indices into allVariables; the names aren't copied but refer to variableNames
+  std::unordered_map<const char*, unsigned int, CStrHash, CStrEqual> nameIndex;
+  std::unordered_map<fmi2_value_reference_t, unsigned int> realVRIndex;
+
+  ResultFileSignals_t realSignals;
+  ResultFileSignals_t intSignals;
+  ResultFileSignals_t boolSignals;
+  std::vector<fmi2_boolean_t> boolSignalValues;
 
   DirectedGraph outputsGraph;
   DirectedGraph initialUnknownsGraph;
@@ -161,6 +249,8 @@ private:
   fmi2_real_t tcur;
   fmi2_real_t relativeTolerance;
   std::string variableFilter;
+  double communicationInterval; ///< own communication interval or 0 for the one of the model
+  bool holdInputs;              ///< between two own communication points of a multirate schedule
 
   // ME
   fmi2_boolean_t callEventUpdate;
@@ -172,8 +262,26 @@ private:
   double* states_nominal;
   double* event_indicators;
   double* event_indicators_prev;
+  bool stateEvent; ///< CVODE stopped at a zero-crossing of an event indicator
+  bool completedIntegratorStepNotNeeded;
   Solver_t solverMethod;
+  LinearSolver_t linearSolver;
   SolverData_t solverData;
+  std::map<std::string, double> solverOptions; ///< only the options that differ from the defaults
+  oms_solver_statistics_t solverStatistics;
+
+  // sparsity pattern of the state Jacobian df/dx in compressed column format
+  std::vector<int> jacobianColPtrs;
+  std::vector<int> jacobianRowVals;
+  std::vector< std::vector<int> > jacobianColorGroups; ///< structurally orthogonal columns
+
+  // explicit Runge-Kutta solvers
+  std::vector<double> rkStages;
+  double rkStepSize; ///< current step size of dopri5
+
+  // forward sensitivities dx/dp, integrated along with the states by CVODE
+  std::vector<fmi2_value_reference_t> sensitivityParameters;
+  std::vector<double> sensitivities; ///< n_states x n_params, column by column
 };
 
 #endif
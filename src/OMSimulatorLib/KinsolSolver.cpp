@@ -0,0 +1,208 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-CurrentYear, Open Source Modelica Consortium (OSMC),
+ * c/o Linköpings universitet, Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF GPL VERSION 3 LICENSE OR
+ * THIS OSMC PUBLIC LICENSE (OSMC-PL) VERSION 1.2.
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES
+ * RECIPIENT'S ACCEPTANCE OF THE OSMC PUBLIC LICENSE OR THE GPL VERSION 3,
+ * ACCORDING TO RECIPIENTS CHOICE.
+ *
+ * The OpenModelica software and the Open Source Modelica
+ * Consortium (OSMC) Public License (OSMC-PL) are obtained
+ * from OSMC, either from the above address,
+ * from the URLs: http://www.ida.liu.se/projects/OpenModelica or
+ * http://www.openmodelica.org, and in the OpenModelica distribution.
+ * GNU version 3 is obtained from: http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without
+ * even the implied warranty of  MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE, EXCEPT AS EXPRESSLY SET FORTH
+ * IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE CONDITIONS OF OSMC-PL.
+ *
+ * See the full OSMC Public License conditions for more details.
+ *
+ */
+
+#include "KinsolSolver.h"
+#include "FMUWrapper.h"
+#include "Logging.h"
+
+#include "kinsol/kinsol.h"             /* prototypes for KINSOL fcts., consts. */
+#include "kinsol/kinsol_dense.h"       /* prototype for KINDense */
+#include "nvector/nvector_serial.h"    /* serial N_Vector types, fcts., macros */
+#include "sundials/sundials_dense.h"   /* definitions DlsMat DENSE_ELEM */
+#include "sundials/sundials_types.h"   /* definition of type realtype */
+
+/**
+ * A Jacobian is reused for the next call of KinsolSolver::solve if the
+ * current solve converged within this number of Newton iterations.
+ */
+#define OMS_KINSOL_MAX_ITERATIONS_REUSE_JACOBIAN 3
+
+void kinsol_err_handler(int error_code, const char *module, const char *function, char *msg, void *user_data)
+{
+  logDebug("KINSOL (" + std::string(function) + "): " + std::string(msg));
+}
+
+KinsolSolver::KinsolSolver(DirectedGraph& graph, const std::vector< std::pair<int, int> >& SCC, std::unordered_map<std::string, FMUWrapper*>& fmuInstances, double tolerance)
+  : size(SCC.size()), mem(NULL), useDirectionalDerivatives(true), reuseJacobian(false)
+{
+  logTrace();
+
+  for (int i=0; i<size; ++i)
+  {
+    const Variable& output = graph.nodes[SCC[i].first];
+    const Variable& input = graph.nodes[SCC[i].second];
+    outputs.push_back(output);
+    inputs.push_back(input);
+    outputFMUs.push_back(fmuInstances[output.getFMUInstanceName()]);
+    inputFMUs.push_back(fmuInstances[input.getFMUInstanceName()]);
+  }
+
+  // dy_i/du_j can only be non-zero if output i and input j belong to the same FMU
+  jacobianRows.resize(size);
+  jacobianRowsVR.resize(size);
+  for (int j=0; j<size; ++j)
+  {
+    if (!inputFMUs[j]->providesDirectionalDerivatives())
+      useDirectionalDerivatives = false;
+
+    for (int i=0; i<size; ++i)
+    {
+      if (outputFMUs[i] == inputFMUs[j])
+      {
+        jacobianRows[j].push_back(i);
+        jacobianRowsVR[j].push_back(outputs[i].getValueReference());
+      }
+    }
+  }
+
+  u = N_VNew_Serial(size);
+  if (!u) logFatal("SUNDIALS_ERROR: N_VNew_Serial() failed - returned NULL pointer");
+  scale = N_VNew_Serial(size);
+  if (!scale) logFatal("SUNDIALS_ERROR: N_VNew_Serial() failed - returned NULL pointer");
+  N_VConst_Serial(1.0, scale);
+
+  mem = KINCreate();
+  if (!mem) logFatal("SUNDIALS_ERROR: KINCreate() failed - returned NULL pointer");
+
+  int flag = KINSetUserData(mem, (void*)this);
+  if (flag < 0) logFatal("SUNDIALS_ERROR: KINSetUserData() failed with flag = " + std::to_string(flag));
+  flag = KINSetErrHandlerFn(mem, kinsol_err_handler, NULL);
+  if (flag < 0) logFatal("SUNDIALS_ERROR: KINSetErrHandlerFn() failed with flag = " + std::to_string(flag));
+  flag = KINInit(mem, KinsolSolver::residual, u);
+  if (flag < 0) logFatal("SUNDIALS_ERROR: KINInit() failed with flag = " + std::to_string(flag));
+  flag = KINDense(mem, size);
+  if (flag < 0) logFatal("SUNDIALS_ERROR: KINDense() failed with flag = " + std::to_string(flag));
+
+  if (useDirectionalDerivatives)
+  {
+    flag = KINDlsSetDenseJacFn(mem, KinsolSolver::jacobian);
+    if (flag < 0) logFatal("SUNDIALS_ERROR: KINDlsSetDenseJacFn() failed with flag = " + std::to_string(flag));
+  }
+
+  flag = KINSetFuncNormTol(mem, tolerance);
+  if (flag < 0) logFatal("SUNDIALS_ERROR: KINSetFuncNormTol() failed with flag = " + std::to_string(flag));
+  flag = KINSetNumMaxIters(mem, 100);
+  if (flag < 0) logFatal("SUNDIALS_ERROR: KINSetNumMaxIters() failed with flag = " + std::to_string(flag));
+
+  logInfo("KINSOL: algebraic loop of size " + std::to_string(size) + " uses " + (useDirectionalDerivatives ? "directional derivatives" : "finite differences") + " for the Jacobian");
+}
+
+KinsolSolver::~KinsolSolver()
+{
+  logTrace();
+  N_VDestroy_Serial(u);
+  N_VDestroy_Serial(scale);
+  KINFree(&mem);
+}
+
+void KinsolSolver::setInputs(N_Vector u)
+{
+  for (int i=0; i<size; ++i)
+    inputFMUs[i]->setRealInput(inputs[i], NV_Ith_S(u, i));
+}
+
+int KinsolSolver::residual(N_Vector u, N_Vector fval, void *user_data)
+{
+  KinsolSolver* solver = (KinsolSolver*)user_data;
+
+  solver->setInputs(u);
+  for (int i=0; i<solver->size; ++i)
+    NV_Ith_S(fval, i) = NV_Ith_S(u, i) - solver->outputFMUs[i]->getReal(solver->outputs[i]);
+
+  return 0;
+}
+
+int KinsolSolver::jacobian(long int N, N_Vector u, N_Vector fu, DlsMat J, void *user_data, N_Vector tmp1, N_Vector tmp2)
+{
+  KinsolSolver* solver = (KinsolSolver*)user_data;
+
+  // J = I - dy/du
+  solver->setInputs(u);
+  for (long int j=0; j<N; ++j)
+  {
+    for (long int i=0; i<N; ++i)
+      DENSE_ELEM(J, i, j) = (i == j) ? 1.0 : 0.0;
+
+    const std::vector<int>& rows = solver->jacobianRows[j];
+    if (rows.empty())
+      continue;
+
+    const fmi2_value_reference_t vr = solver->inputs[j].getValueReference();
+    const double seed = 1.0;
+    std::vector<double> dy(rows.size());
+    if (!solver->inputFMUs[j]->getDirectionalDerivative(&solver->jacobianRowsVR[j][0], rows.size(), &vr, 1, &seed, &dy[0]))
+      return -1;
+
+    for (size_t k=0; k<rows.size(); ++k)
+      DENSE_ELEM(J, rows[k], j) -= dy[k];
+  }
+
+  return 0;
+}
+
+oms_status_t KinsolSolver::solve()
+{
+  // initial guess: current values of the outputs
+  for (int i=0; i<size; ++i)
+    NV_Ith_S(u, i) = outputFMUs[i]->getReal(outputs[i]);
+
+  int flag = KINSetNoInitSetup(mem, reuseJacobian ? TRUE : FALSE);
+  if (flag < 0) logFatal("SUNDIALS_ERROR: KINSetNoInitSetup() failed with flag = " + std::to_string(flag));
+
+  flag = KINSol(mem, u, KIN_LINESEARCH, scale, scale);
+  if (flag < 0 && reuseJacobian)
+  {
+    // try again with a fresh Jacobian
+    logDebug("KinsolSolver::solve: retry with updated Jacobian");
+    for (int i=0; i<size; ++i)
+      NV_Ith_S(u, i) = outputFMUs[i]->getReal(outputs[i]);
+
+    flag = KINSetNoInitSetup(mem, FALSE);
+    if (flag < 0) logFatal("SUNDIALS_ERROR: KINSetNoInitSetup() failed with flag = " + std::to_string(flag));
+    flag = KINSol(mem, u, KIN_LINESEARCH, scale, scale);
+  }
+
+  if (flag < 0)
+  {
+    reuseJacobian = false;
+    logError("KinsolSolver::solve: KINSol() failed with flag = " + std::to_string(flag));
+    return oms_status_error;
+  }
+
+  // keep the Jacobian as long as the convergence is fast
+  long int nni = 0;
+  KINGetNumNonlinSolvIters(mem, &nni);
+  reuseJacobian = (nni <= OMS_KINSOL_MAX_ITERATIONS_REUSE_JACOBIAN);
+
+  // make sure that the FMUs see the solution
+  setInputs(u);
+  return oms_status_ok;
+}
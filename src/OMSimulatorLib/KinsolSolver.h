@@ -0,0 +1,96 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-CurrentYear, Open Source Modelica Consortium (OSMC),
+ * c/o Linköpings universitet, Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF GPL VERSION 3 LICENSE OR
+ * THIS OSMC PUBLIC LICENSE (OSMC-PL) VERSION 1.2.
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES
+ * RECIPIENT'S ACCEPTANCE OF THE OSMC PUBLIC LICENSE OR THE GPL VERSION 3,
+ * ACCORDING TO RECIPIENTS CHOICE.
+ *
+ * The OpenModelica software and the Open Source Modelica
+ * Consortium (OSMC) Public License (OSMC-PL) are obtained
+ * from OSMC, either from the above address,
+ * from the URLs: http://www.ida.liu.se/projects/OpenModelica or
+ * http://www.openmodelica.org, and in the OpenModelica distribution.
+ * GNU version 3 is obtained from: http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without
+ * even the implied warranty of  MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE, EXCEPT AS EXPRESSLY SET FORTH
+ * IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE CONDITIONS OF OSMC-PL.
+ *
+ * See the full OSMC Public License conditions for more details.
+ *
+ */
+
+#ifndef _OMS_KINSOL_SOLVER_H_
+#define _OMS_KINSOL_SOLVER_H_
+
+#include "DirectedGraph.h"
+#include "Variable.h"
+#include "Types.h"
+
+#include <fmilib.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "nvector/nvector_serial.h"  /* serial N_Vector types, fcts., macros */
+#include "sundials/sundials_direct.h" /* definitions DlsMat */
+
+class FMUWrapper;
+
+/**
+ * \brief Newton-type solver for algebraic loops between FMUs.
+ *
+ * The loop is formulated as F(u) = u - y(u) = 0, where u are the inputs of
+ * the connections in the strongly connected component and y the
+ * corresponding outputs. The Jacobian is either evaluated using the
+ * directional derivatives of the involved FMUs or approximated by KINSOL
+ * using finite differences. It is kept across calls of solve() until the
+ * number of Newton iterations indicates that it became outdated.
+ */
+class KinsolSolver
+{
+public:
+  KinsolSolver(DirectedGraph& graph, const std::vector< std::pair<int, int> >& SCC, std::unordered_map<std::string, FMUWrapper*>& fmuInstances, double tolerance);
+  ~KinsolSolver();
+
+  oms_status_t solve();
+
+private:
+  void setInputs(N_Vector u);
+
+  static int residual(N_Vector u, N_Vector fval, void *user_data);
+  static int jacobian(long int N, N_Vector u, N_Vector fu, DlsMat J, void *user_data, N_Vector tmp1, N_Vector tmp2);
+
+private:
+  long int size;
+  std::vector<Variable> outputs;
+  std::vector<Variable> inputs;
+  std::vector<FMUWrapper*> outputFMUs;
+  std::vector<FMUWrapper*> inputFMUs;
+
+  // sparsity of dy/du: outputs that belong to the same FMU as input j
+  std::vector< std::vector<int> > jacobianRows;
+  std::vector< std::vector<fmi2_value_reference_t> > jacobianRowsVR;
+
+  void *mem;
+  N_Vector u;
+  N_Vector scale;
+  bool useDirectionalDerivatives;
+  bool reuseJacobian;
+
+private:
+  // Stop the compiler generating methods of copy the object
+  KinsolSolver(KinsolSolver const& copy);            // Not Implemented
+  KinsolSolver& operator=(KinsolSolver const& copy); // Not Implemented
+};
+
+#endif
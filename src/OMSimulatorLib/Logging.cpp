@@ -80,6 +80,7 @@ Log& Log::getInstance()
 
 void Log::Info(const std::string& msg)
 {
+  std::lock_guard<std::recursive_mutex> lock(m);
   logFile << TimeStr() << " | info:    " << msg << endl;
   if (useStdStream)
     cout << "info:    " << msg << endl;
@@ -87,6 +88,7 @@ void Log::Info(const std::string& msg)
 
 void Log::Debug(const std::string& msg)
 {
+  std::lock_guard<std::recursive_mutex> lock(m);
   logFile << TimeStr() << " | debug:   " << msg << endl;
   if (useStdStream)
     cout << "debug:   " << msg << endl;
@@ -94,6 +96,7 @@ void Log::Debug(const std::string& msg)
 
 void Log::Warning(const std::string& msg)
 {
+  std::lock_guard<std::recursive_mutex> lock(m);
   numWarnings++;
   logFile << TimeStr() << " | warning: " << msg << endl;
   if (useStdStream)
@@ -102,6 +105,7 @@ void Log::Warning(const std::string& msg)
 
 void Log::Error(const std::string& msg)
 {
+  std::lock_guard<std::recursive_mutex> lock(m);
   numErrors++;
   logFile << TimeStr() << " | error:   " << msg << endl;
   cerr << "error:   " << msg << endl;
@@ -109,6 +113,7 @@ void Log::Error(const std::string& msg)
 
 void Log::Fatal(const std::string& msg)
 {
+  std::lock_guard<std::recursive_mutex> lock(m);
   numErrors++;
   logFile << TimeStr() << " | fatal:   " << msg << endl;
   cerr << "fatal:   " << msg << endl;
@@ -117,6 +122,7 @@ void Log::Fatal(const std::string& msg)
 
 void Log::Trace(const std::string& function, const std::string& file, const long line)
 {
+  std::lock_guard<std::recursive_mutex> lock(m);
   logFile << TimeStr() << " | trace:   " << function << " (" << file << ":" << line << ")" << endl;
   if (useStdStream)
     cout << "trace:   " << function << " (" << file << ":" << line << ")" << endl;
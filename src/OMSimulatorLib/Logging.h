@@ -34,6 +34,7 @@
 
 #include <string>
 #include <fstream>
+#include <mutex>
 
 //#define OMS_DEBUG_LOGGING
 
@@ -67,6 +68,7 @@ private:
   Log& operator=(Log const& copy); // Not Implemented
 
   std::ofstream logFile;
+  std::recursive_mutex m; ///< FMUs might log from different threads
   unsigned int numWarnings;
   unsigned int numErrors;
   bool useStdStream;
@@ -39,16 +39,20 @@
 #include <string>
 #include <cstring>
 #include <errno.h>
+#include <stdint.h>
+#include <algorithm>
 
 MATWriter::MATWriter(unsigned int bufferSize)
   : ResultWriter(bufferSize),
-    pFile(NULL)
+    pFile(NULL),
+    pIntFile(NULL),
+    pBoolFile(NULL)
 {
 }
 
 MATWriter::~MATWriter()
 {
-  closeFile();
+  close();
 }
 
 bool MATWriter::createFile(const std::string& filename, double startTime, double stopTime)
@@ -131,8 +135,9 @@ bool MATWriter::createFile(const std::string& filename, double startTime, double
   dataInfo[3] = -1;
   for (int i = 0; i < signals.size(); ++i)
   {
-    dataInfo[4 * (1 + i) + 0] = 2;
-    dataInfo[4 * (1 + i) + 1] = 2 + i;
+    // real signals are stored in data_2, integers in data_3 and booleans in data_4
+    dataInfo[4 * (1 + i) + 0] = SignalType_REAL == signals[i].type ? 2 : (SignalType_INT == signals[i].type ? 3 : 4);
+    dataInfo[4 * (1 + i) + 1] = 1 + columns[i];
     dataInfo[4 * (1 + i) + 2] = 0;
     dataInfo[4 * (1 + i) + 3] = -1;
   }
@@ -157,8 +162,15 @@ bool MATWriter::createFile(const std::string& filename, double startTime, double
   data_1[(1 + parameters.size())] = stopTime;
   for (int i = 0; i < parameters.size(); ++i)
   {
-    data_1[i + 1] = parameters[i].value.realValue;
-    data_1[(1 + parameters.size()) + i + 1] = parameters[i].value.realValue;
+    double value;
+    if (SignalType_REAL == parameters[i].signal.type)
+      value = parameters[i].value.realValue;
+    else if (SignalType_INT == parameters[i].signal.type)
+      value = parameters[i].value.intValue;
+    else
+      value = parameters[i].value.boolValue ? 1.0 : 0.0;
+    data_1[i + 1] = value;
+    data_1[(1 + parameters.size()) + i + 1] = value;
   }
   writeMatVer4Matrix(pFile, "data_1", 1 + parameters.size(), 2, data_1, MatVer4Type_DOUBLE);
   delete[] data_1;
@@ -170,22 +182,89 @@ bool MATWriter::createFile(const std::string& filename, double startTime, double
   // Class Type: Double Precision Array
   //  Data Type: IEEE 754 double-precision
   pos_data_2 = ftell(pFile);
-  writeMatVer4Matrix(pFile, "data_2", 1 + signals.size(), 0, NULL, MatVer4Type_DOUBLE);
+  writeMatVer4Matrix(pFile, "data_2", 1 + nReals, 0, NULL, MatVer4Type_DOUBLE);
+  nRows = 0;
+
+  // data_3 and data_4 can only be written after data_2 is complete
+  if (nInts > 0)
+    pIntFile = tmpfile();
+  if (nBools > 0)
+    pBoolFile = tmpfile();
+  if ((nInts > 0 && !pIntFile) || (nBools > 0 && !pBoolFile))
+  {
+    logError("MATWriter::createFile: " + std::string(strerror(errno)));
+    closeFile();
+    return false;
+  }
 
   return true;
 }
 
+/**
+ * Appends the content of a temporary file as matrix to the result file.
+ */
+static void appendTemporaryFile(FILE* pFile, FILE* pTmpFile, const char* name, size_t rows, size_t cols, MatVer4Type_t type, size_t size)
+{
+  long pos = ftell(pFile);
+  writeMatVer4Matrix(pFile, name, rows, 0, NULL, type);
+  if (!pTmpFile || rows == 0)
+    return;
+
+  const size_t chunk = 1024;
+  char* buffer = new char[chunk*rows*size];
+  rewind(pTmpFile);
+  while (cols > 0)
+  {
+    size_t n = fread(buffer, rows*size, std::min(chunk, cols), pTmpFile);
+    if (n == 0)
+      break;
+    appendMatVer4Matrix(pFile, pos, name, rows, n, buffer, type);
+    cols -= n;
+  }
+  delete[] buffer;
+}
+
 void MATWriter::closeFile()
 {
   if (pFile)
   {
-    writeFile();
+    //       Name: data_3
+    //       Rank: 2
+    // Dimensions: nIntegerSeries x nPoints
+    // Class Type: 32-bit, signed integer array
+    //  Data Type: 32-bit, signed integer
+    fseek(pFile, 0, SEEK_END);
+    appendTemporaryFile(pFile, pIntFile, "data_3", nInts, nRows, MatVer4Type_INT32, sizeof(int32_t));
+
+    //       Name: data_4
+    //       Rank: 2
+    // Dimensions: nBooleanSeries x nPoints
+    // Class Type: 8-bit, unsigned integer array
+    //  Data Type: 8-bit, unsigned integer
+    appendTemporaryFile(pFile, pBoolFile, "data_4", nBools, nRows, MatVer4Type_UINT8, sizeof(uint8_t));
+
     fclose(pFile);
     pFile = NULL;
   }
+
+  if (pIntFile)
+  {
+    fclose(pIntFile);
+    pIntFile = NULL;
+  }
+  if (pBoolFile)
+  {
+    fclose(pBoolFile);
+    pBoolFile = NULL;
+  }
 }
 
-void MATWriter::writeFile()
+void MATWriter::writeFile(const Buffer& buffer)
 {
-  appendMatVer4Matrix(pFile, pos_data_2, "data_2", 1 + signals.size(), nEmits, data_2, MatVer4Type_DOUBLE);
+  appendMatVer4Matrix(pFile, pos_data_2, "data_2", 1 + nReals, buffer.nRows, buffer.data_2, MatVer4Type_DOUBLE);
+  if (pIntFile)
+    fwrite(buffer.data_3, sizeof(int32_t), nInts * buffer.nRows, pIntFile);
+  if (pBoolFile)
+    fwrite(buffer.data_4, sizeof(uint8_t), nBools * buffer.nRows, pBoolFile);
+  nRows += buffer.nRows;
 }
@@ -47,11 +47,14 @@ public:
 protected:
   bool createFile(const std::string& filename, double startTime, double stopTime);
   void closeFile();
-  void writeFile();
+  void writeFile(const Buffer& buffer);
 
 private:
   FILE *pFile;
+  FILE *pIntFile;  ///< temporary storage for data_3
+  FILE *pBoolFile; ///< temporary storage for data_4
   long pos_data_2;
+  unsigned int nRows;
 };
 
 #endif
@@ -34,6 +34,7 @@
 
 #include "Logging.h"
 
+#include <stdint.h>
 #include <string.h>
 
 MatReader::MatReader(const char* filename)
@@ -46,6 +47,17 @@ MatReader::MatReader(const char* filename)
   dataInfo = readMatVer4Matrix(pFile);
   data_1 = readMatVer4Matrix(pFile);
   data_2 = readMatVer4Matrix(pFile);
+
+  // integer and boolean signals aren't available in older result files
+  data_3 = NULL;
+  data_4 = NULL;
+  int c = fgetc(pFile);
+  if (EOF != c)
+  {
+    ungetc(c, pFile);
+    data_3 = readMatVer4Matrix(pFile);
+    data_4 = readMatVer4Matrix(pFile);
+  }
   fclose(pFile);
 }
 
@@ -55,6 +67,8 @@ MatReader::~MatReader()
   deleteMatVer4Matrix(&dataInfo);
   deleteMatVer4Matrix(&data_1);
   deleteMatVer4Matrix(&data_2);
+  deleteMatVer4Matrix(&data_3);
+  deleteMatVer4Matrix(&data_4);
 }
 
 ResultReader::Series* MatReader::getSeries(const char* var)
@@ -82,7 +96,14 @@ ResultReader::Series* MatReader::getSeries(const char* var)
     data = data_1;
   else if (info[0] == 2)
     data = data_2;
-  else
+  else if (info[0] == 3)
+    data = data_3;
+  else if (info[0] == 4)
+    data = data_4;
+
+  // integer and boolean signals share the time points of data_2
+  MatVer4Matrix *time = info[0] > 2 ? data_2 : data;
+  if (!data || !time || data->header.ncols != time->header.ncols)
     return NULL;
 
   Series *series = new Series;
@@ -93,8 +114,13 @@ ResultReader::Series* MatReader::getSeries(const char* var)
 
   for (int i = 0; i < series->length; ++i)
   {
-    series->time[i] = ((double*)data->data)[data->header.mrows * i];
-    series->value[i] = ((double*)data->data)[data->header.mrows * i + (info[1] - 1)];
+    series->time[i] = ((double*)time->data)[time->header.mrows * i];
+    if (info[0] == 3)
+      series->value[i] = ((int32_t*)data->data)[data->header.mrows * i + (info[1] - 1)];
+    else if (info[0] == 4)
+      series->value[i] = ((uint8_t*)data->data)[data->header.mrows * i + (info[1] - 1)];
+    else
+      series->value[i] = ((double*)data->data)[data->header.mrows * i + (info[1] - 1)];
   }
 
   return series;
@@ -48,6 +48,8 @@ private:
   MatVer4Matrix* dataInfo;
   MatVer4Matrix* data_1;
   MatVer4Matrix* data_2;
+  MatVer4Matrix* data_3; ///< integer signals (optional)
+  MatVer4Matrix* data_4; ///< boolean signals (optional)
 };
 
 #endif
@@ -73,6 +73,7 @@ int writeMatVer4Matrix(FILE* file, const char* name, size_t rows, size_t cols, c
   case MatVer4Type_INT32:
     size = sizeof(int32_t);
     break;
+  case MatVer4Type_UINT8:
   case MatVer4Type_CHAR:
     size = sizeof(uint8_t);
     break;
@@ -113,6 +114,7 @@ int appendMatVer4Matrix(FILE* file, long position, const char* name, size_t rows
   case MatVer4Type_INT32:
     size = sizeof(int32_t);
     break;
+  case MatVer4Type_UINT8:
   case MatVer4Type_CHAR:
     size = sizeof(uint8_t);
     break;
@@ -160,6 +162,7 @@ MatVer4Matrix* readMatVer4Matrix(FILE* file)
   case MatVer4Type_INT32:
     size = sizeof(int32_t);
     break;
+  case MatVer4Type_UINT8:
   case MatVer4Type_CHAR:
     size = sizeof(uint8_t);
     break;
@@ -191,6 +194,7 @@ int skipMatVer4Matrix(FILE* file)
   case MatVer4Type_INT32:
     size = sizeof(int32_t);
     break;
+  case MatVer4Type_UINT8:
   case MatVer4Type_CHAR:
     size = sizeof(uint8_t);
     break;
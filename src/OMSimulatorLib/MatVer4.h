@@ -38,6 +38,7 @@ enum MatVer4Type_t
 {
   MatVer4Type_DOUBLE = 0,
   MatVer4Type_INT32 = 20,
+  MatVer4Type_UINT8 = 50,
   MatVer4Type_CHAR = 51
 };
 
@@ -32,6 +32,9 @@
 #include "OMSimulator.h"
 #include "CompositeModel.h"
 #include "Logging.h"
+#include "Timeline.h"
+#include "FMUCache.h"
+#include "Ensemble.h"
 #include "Settings.h"
 #include "GlobalSettings.h"
 #include "Version.h"
@@ -57,6 +60,19 @@ void* oms_loadModel(const char* filename)
   return (void*)pModel;
 }
 
+void* oms_cloneModel(void* model)
+{
+  logTrace();
+  if (!model)
+  {
+    logError("oms_cloneModel: invalid pointer");
+    return NULL;
+  }
+
+  CompositeModel* pModel = (CompositeModel*)model;
+  return (void*)pModel->clone();
+}
+
 void oms_unload(void* model)
 {
   logTrace();
@@ -122,6 +138,99 @@ void oms_setBoolean(void *model, const char *var, int value)
   pModel->setBoolean(var, value);
 }
 
+int oms_getVariableHandle(void* model, const char* var)
+{
+  logTrace();
+  if (!model)
+  {
+    logError("oms_getVariableHandle: invalid pointer");
+    return -1;
+  }
+
+  CompositeModel *pModel = (CompositeModel *)model;
+  return pModel->getVariableHandle(var);
+}
+
+oms_status_t oms_setRealByHandle(void* model, int handle, double value)
+{
+  logTrace();
+  if (!model)
+  {
+    logError("oms_setRealByHandle: invalid pointer");
+    return oms_status_error;
+  }
+
+  CompositeModel *pModel = (CompositeModel *)model;
+  return pModel->setRealByHandle(handle, value);
+}
+
+double oms_getRealByHandle(void* model, int handle)
+{
+  logTrace();
+  if (!model)
+  {
+    // TODO: Provide suitable return value to handle unsuccessful calls.
+    logFatal("oms_getRealByHandle: invalid pointer");
+  }
+
+  CompositeModel *pModel = (CompositeModel *)model;
+  double value = 0.0;
+  pModel->getRealByHandle(handle, &value);
+  return value;
+}
+
+oms_status_t oms_setReals(void* model, const int* handles, int n, const double* values)
+{
+  logTrace();
+  if (!model)
+  {
+    logError("oms_setReals: invalid pointer");
+    return oms_status_error;
+  }
+
+  CompositeModel *pModel = (CompositeModel *)model;
+  return pModel->setReals(handles, n, values);
+}
+
+oms_status_t oms_getReals(void* model, const int* handles, int n, double* values)
+{
+  logTrace();
+  if (!model)
+  {
+    logError("oms_getReals: invalid pointer");
+    return oms_status_error;
+  }
+
+  CompositeModel *pModel = (CompositeModel *)model;
+  return pModel->getReals(handles, n, values);
+}
+
+oms_status_t oms_setSensitivityParameters(void* model, const int* handles, int n)
+{
+  logTrace();
+  if (!model)
+  {
+    logError("oms_setSensitivityParameters: invalid pointer");
+    return oms_status_error;
+  }
+
+  CompositeModel *pModel = (CompositeModel *)model;
+  return pModel->setSensitivityParameters(handles, n);
+}
+
+oms_status_t oms_getRealSensitivities(void* model, const int* handles, int n, double* sensitivities)
+{
+  logTrace();
+  if (!model)
+  {
+    logError("oms_getRealSensitivities: invalid pointer");
+    return oms_status_error;
+  }
+
+  CompositeModel *pModel = (CompositeModel *)model;
+  return pModel->getRealSensitivities(handles, n, sensitivities);
+}
+
 double oms_getReal(void *model, const char *var)
 {
   logTrace();
@@ -187,6 +296,22 @@ oms_status_t oms_simulate(void* model)
   return pModel->simulate();
 }
 
+oms_status_t oms_runEnsemble(void* model, const char* parameterTable, int numWorkers, const char* resultFile)
+{
+  logTrace();
+  if (!model)
+  {
+    logError("oms_runEnsemble: invalid pointer");
+    return oms_status_error;
+  }
+
+  CompositeModel* pModel = (CompositeModel*)model;
+  Ensemble ensemble(*pModel);
+  if (!ensemble.loadParameterTable(parameterTable))
+    return oms_status_error;
+  return ensemble.run(numWorkers, resultFile ? resultFile : "");
+}
+
 oms_status_t oms_doSteps(const void* model, const int numberOfSteps)
 {
   logTrace();
@@ -275,8 +400,7 @@ oms_status_t oms_initialize(void* model)
   }
 
   CompositeModel* pModel = (CompositeModel*)model;
-  pModel->initialize();
-  return oms_status_ok;
+  return pModel->initialize();
 }
 
 oms_status_t oms_terminate(void* model)
@@ -320,12 +444,83 @@ oms_status_t oms_getCurrentTime(const void* model, double* time)
   return pModel->getCurrentTime(time);
 }
 
+void* oms_saveSnapshot(void* model)
+{
+  logTrace();
+  if (!model)
+  {
+    logError("oms_saveSnapshot: invalid pointer");
+    return NULL;
+  }
+
+  CompositeModel* pModel = (CompositeModel*)model;
+  return (void*)pModel->saveSnapshot();
+}
+
+oms_status_t oms_restoreSnapshot(void* model, void* snapshot)
+{
+  logTrace();
+  if (!model || !snapshot)
+  {
+    logError("oms_restoreSnapshot: invalid pointer");
+    return oms_status_error;
+  }
+
+  CompositeModel* pModel = (CompositeModel*)model;
+  return pModel->restoreSnapshot((CompositeModel::Snapshot*)snapshot);
+}
+
+void oms_freeSnapshot(void* model, void* snapshot)
+{
+  logTrace();
+  if (!model)
+  {
+    logError("oms_freeSnapshot: invalid pointer");
+    return;
+  }
+
+  CompositeModel* pModel = (CompositeModel*)model;
+  pModel->freeSnapshot((CompositeModel::Snapshot*)snapshot);
+}
+
+oms_status_t oms_writeSnapshot(void* model, void* snapshot, const char* filename)
+{
+  logTrace();
+  if (!model || !snapshot)
+  {
+    logError("oms_writeSnapshot: invalid pointer");
+    return oms_status_error;
+  }
+
+  CompositeModel* pModel = (CompositeModel*)model;
+  return pModel->writeSnapshot((CompositeModel::Snapshot*)snapshot, filename);
+}
+
+void* oms_readSnapshot(void* model, const char* filename)
+{
+  logTrace();
+  if (!model)
+  {
+    logError("oms_readSnapshot: invalid pointer");
+    return NULL;
+  }
+
+  CompositeModel* pModel = (CompositeModel*)model;
+  return (void*)pModel->readSnapshot(filename);
+}
+
 void oms_setTempDirectory(const char* filename)
 {
   logTrace();
   GlobalSettings::getInstance().SetTempDirectory(filename);
 }
 
+void oms_setPersistentFMUCache(int persistent)
+{
+  logTrace();
+  FMUCache::getInstance().SetPersistent(persistent != 0);
+}
+
 void oms_setWorkingDirectory(const char* path)
 {
   logTrace();
@@ -380,11 +575,180 @@ void oms_setSolverMethod(void* model, const char* instanceName, const char* meth
   pModel->SetSolverMethod(instanceName, method);
 }
 
+void oms_setLinearSolver(void* model, const char* instanceName, const char* solver)
+{
+  logTrace();
+  if (!model)
+  {
+    logError("oms_setLinearSolver: invalid pointer");
+    return;
+  }
+
+  CompositeModel* pModel = (CompositeModel*)model;
+  pModel->SetLinearSolver(instanceName, solver);
+}
+
+oms_status_t oms_setInstanceCommunicationInterval(void* model, const char* instanceName, double communicationInterval)
+{
+  logTrace();
+  if (!model)
+  {
+    logError("oms_setInstanceCommunicationInterval: invalid pointer");
+    return oms_status_error;
+  }
+
+  CompositeModel* pModel = (CompositeModel*)model;
+  return pModel->setInstanceCommunicationInterval(instanceName, communicationInterval);
+}
+
+oms_status_t oms_setSolverOption(void* model, const char* instanceName, const char* option, double value)
+{
+  logTrace();
+  if (!model)
+  {
+    logError("oms_setSolverOption: invalid pointer");
+    return oms_status_error;
+  }
+
+  CompositeModel* pModel = (CompositeModel*)model;
+  return pModel->setSolverOption(instanceName, option, value);
+}
+
+oms_status_t oms_getSolverStatistics(void* model, const char* instanceName, oms_solver_statistics_t* statistics)
+{
+  logTrace();
+  if (!model || !statistics)
+  {
+    logError("oms_getSolverStatistics: invalid pointer");
+    return oms_status_error;
+  }
+
+  CompositeModel* pModel = (CompositeModel*)model;
+  return pModel->getSolverStatistics(instanceName, statistics);
+}
+
+void oms_setNumProcs(void* model, int numProcs)
+{
+  logTrace();
+  if (!model)
+  {
+    logError("oms_setNumProcs: invalid pointer");
+    return;
+  }
+
+  if (numProcs < 1)
+  {
+    logError("oms_setNumProcs: invalid number of threads (" + std::to_string(numProcs) + ")");
+    return;
+  }
+
+  CompositeModel* pModel = (CompositeModel*)model;
+  pModel->getSettings().SetNumProcs(numProcs);
+}
+
+void oms_setAlgLoopSolver(void* model, const char* solver)
+{
+  logTrace();
+  if (!model)
+  {
+    logError("oms_setAlgLoopSolver: invalid pointer");
+    return;
+  }
+
+  CompositeModel* pModel = (CompositeModel*)model;
+  pModel->SetAlgLoopSolver(solver);
+}
+
+void oms_setMasterAlgorithm(void* model, const char* algorithm)
+{
+  logTrace();
+  if (!model)
+  {
+    logError("oms_setMasterAlgorithm: invalid pointer");
+    return;
+  }
+
+  CompositeModel* pModel = (CompositeModel*)model;
+  pModel->SetMasterAlgorithm(algorithm);
+}
+
+void oms_setAsyncResultFile(void* model, int asyncResultFile)
+{
+  logTrace();
+  if (!model)
+  {
+    logError("oms_setAsyncResultFile: invalid pointer");
+    return;
+  }
+
+  CompositeModel* pModel = (CompositeModel*)model;
+  pModel->getSettings().SetAsyncResultFile(asyncResultFile != 0);
+}
+
+void oms_setAdaptiveStepSize(void* model, int adaptiveStepSize)
+{
+  logTrace();
+  if (!model)
+  {
+    logError("oms_setAdaptiveStepSize: invalid pointer");
+    return;
+  }
+
+  CompositeModel* pModel = (CompositeModel*)model;
+  pModel->getSettings().SetAdaptiveStepSize(adaptiveStepSize != 0);
+}
+
+void oms_setStepSizeBounds(void* model, double minimalStepSize, double maximalStepSize)
+{
+  logTrace();
+  if (!model)
+  {
+    logError("oms_setStepSizeBounds: invalid pointer");
+    return;
+  }
+
+  CompositeModel* pModel = (CompositeModel*)model;
+  pModel->getSettings().SetStepSizeBounds(minimalStepSize, maximalStepSize);
+}
+
+void oms_setCouplingTolerance(void* model, double couplingTolerance)
+{
+  logTrace();
+  if (!model)
+  {
+    logError("oms_setCouplingTolerance: invalid pointer");
+    return;
+  }
+
+  CompositeModel* pModel = (CompositeModel*)model;
+  pModel->getSettings().SetCouplingTolerance(couplingTolerance);
+}
+
 void oms_logToStdStream(int useStdStream)
 {
   Log::getInstance().DumpToStdStream(useStdStream != 0);
 }
 
+void oms_setTracing(int enable)
+{
+  logTrace();
+  Timeline::getInstance().SetEnabled(enable != 0);
+}
+
+oms_status_t oms_exportTrace(const char* filename)
+{
+  logTrace();
+  if (!filename)
+  {
+    logError("oms_exportTrace: invalid filename");
+    return oms_status_error;
+  }
+
+  if (!Timeline::getInstance().exportTrace(filename))
+    return oms_status_error;
+  return oms_status_ok;
+}
+
 const char* oms_getVersion()
 {
   return oms_git_version;
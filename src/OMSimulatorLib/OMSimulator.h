@@ -54,6 +54,17 @@ void* oms_newModel();
  */
 void* oms_loadModel(const char* filename);
 
+/**
+ * \brief Creates an independent copy of a composite model.
+ *
+ * The copy has its own FMU instances, connections and modified parameters,
+ * but doesn't write a result file. The model must not be in simulation mode.
+ *
+ * @param model Model as opaque pointer.
+ * @return copy of the model as opaque pointer, NULL on failure.
+ */
+void* oms_cloneModel(void* model);
+
 // TODO saveModel
 
 /**
@@ -101,6 +112,86 @@ void oms_setBoolean(void *model, const char *var, int value);
 
 // TODO: setString
 
+/**
+ * \brief Resolves a variable for the handle-based get/set functions.
+ *
+ * Resolving a variable once avoids parsing and looking up its name on every
+ * call. Handles are valid as long as the model exists.
+ *
+ * @param model Model as opaque pointer.
+ * @param var   Variable name as string, e.g. "instance.variable".
+ * @return handle of the variable or -1 if it doesn't exist.
+ */
+int oms_getVariableHandle(void* model, const char* var);
+
+/**
+ * \brief Set real value of a resolved variable (parameter or input).
+ *
+ * @param model  Model as opaque pointer.
+ * @param handle Handle returned by oms_getVariableHandle.
+ * @param value  New value.
+ * @return Error status.
+ */
+oms_status_t oms_setRealByHandle(void* model, int handle, double value);
+
+/**
+ * \brief Get real value of a resolved variable.
+ *
+ * @param model  Model as opaque pointer.
+ * @param handle Handle returned by oms_getVariableHandle.
+ * @return value of given variable
+ */
+double oms_getRealByHandle(void* model, int handle);
+
+/**
+ * \brief Set several real values at once.
+ *
+ * @param model   Model as opaque pointer.
+ * @param handles Handles returned by oms_getVariableHandle.
+ * @param n       Number of handles.
+ * @param values  New values, one per handle.
+ * @return Error status.
+ */
+oms_status_t oms_setReals(void* model, const int* handles, int n, const double* values);
+
+/**
+ * \brief Get several real values at once.
+ *
+ * @param model   Model as opaque pointer.
+ * @param handles Handles returned by oms_getVariableHandle.
+ * @param n       Number of handles.
+ * @param values  [out] Values, one per handle.
+ * @return Error status.
+ */
+oms_status_t oms_getReals(void* model, const int* handles, int n, double* values);
+
+/**
+ * \brief Selects the parameters for the forward sensitivity analysis.
+ *
+ * The parameters need to belong to one FMU ME without connected inputs that
+ * provides directional derivatives and is simulated with CVODE. The
+ * sensitivities are then integrated along with the states. Has to be called
+ * before oms_initialize; n=0 switches the sensitivity analysis off.
+ *
+ * @param model   Model as opaque pointer.
+ * @param handles Handles of real parameters returned by oms_getVariableHandle.
+ * @param n       Number of handles.
+ * @return Error status.
+ */
+oms_status_t oms_setSensitivityParameters(void* model, const int* handles, int n);
+
+/**
+ * \brief Get the sensitivities of real variables at the current time.
+ *
+ * @param model         Model as opaque pointer.
+ * @param handles       Handles of real variables of the FMU with the sensitivity parameters.
+ * @param n             Number of handles.
+ * @param sensitivities [out] Row-major n x p matrix with the derivatives of
+ *                      the variables with respect to the p sensitivity parameters.
+ * @return Error status.
+ */
+oms_status_t oms_getRealSensitivities(void* model, const int* handles, int n, double* sensitivities);
+
 /**
  * \brief Get real value.
  *
@@ -145,6 +236,24 @@ void oms_addConnection(void* model, const char* from, const char* to);
  */
 oms_status_t oms_simulate(void* model);
 
+/**
+ * \brief Simulates the model for each parameter set of a table.
+ *
+ * The parameter table is a CSV file with the names of the parameters in the
+ * header and one parameter set per line. The runs are simulated in forked
+ * processes, at most numWorkers at a time. Each run writes its own result
+ * file, with the run index appended to the name of the given result file,
+ * and a summary of all runs is written to "<name>_summary.csv".
+ * Not supported on Windows.
+ *
+ * @param model          Model as opaque pointer.
+ * @param parameterTable Path to the CSV file with the parameter sets.
+ * @param numWorkers     Number of runs that are simulated in parallel.
+ * @param resultFile     Name of the result file, e.g. "model_res.mat"; empty for no result files.
+ * @return Error status.
+ */
+oms_status_t oms_runEnsemble(void* model, const char* parameterTable, int numWorkers, const char* resultFile);
+
 /**
  * \brief In case of variable step sizes or events we cannot know the final time value.
  *
@@ -203,9 +312,61 @@ oms_status_t oms_reset(void* model);
  */
 oms_status_t oms_getCurrentTime(const void* model, double* time);
 
+/**
+ * \brief Saves the states of all FMU instances of a model.
+ *
+ * Requires FMUs that can get and set their state. The model must be in
+ * simulation mode.
+ *
+ * @param model Model as opaque pointer.
+ * @return Snapshot as opaque pointer, NULL on failure.
+ */
+void* oms_saveSnapshot(void* model);
+
+/**
+ * \brief Rolls a model back to a snapshot.
+ *
+ * The result file isn't rewound.
+ *
+ * @param model    Model as opaque pointer.
+ * @param snapshot Snapshot of the same model as opaque pointer.
+ * @return Error status.
+ */
+oms_status_t oms_restoreSnapshot(void* model, void* snapshot);
+
+/**
+ * \brief Frees a snapshot.
+ *
+ * @param model    Model as opaque pointer.
+ * @param snapshot Snapshot of the same model as opaque pointer.
+ */
+void oms_freeSnapshot(void* model, void* snapshot);
+
+/**
+ * \brief Writes a snapshot to a binary file.
+ *
+ * Requires FMUs that can serialize their state.
+ *
+ * @param model    Model as opaque pointer.
+ * @param snapshot Snapshot of the same model as opaque pointer.
+ * @param filename Name of the snapshot file.
+ * @return Error status.
+ */
+oms_status_t oms_writeSnapshot(void* model, void* snapshot, const char* filename);
+
+/**
+ * \brief Reads a snapshot from a binary file.
+ *
+ * @param model    Model as opaque pointer.
+ * @param filename Name of a snapshot file of the same model.
+ * @return Snapshot as opaque pointer, NULL on failure.
+ */
+void* oms_readSnapshot(void* model, const char* filename);
+
 /* Global settings */
 void oms_setTempDirectory(const char* filename);
 void oms_setWorkingDirectory(const char* path);
+void oms_setPersistentFMUCache(int persistent);
 
 /* Local settings */
 void oms_setStartTime(void* model, double startTime);
@@ -216,6 +377,162 @@ void oms_setResultFile(void* model, const char* filename);
 void oms_setSolverMethod(void* model, const char* instanceName, const char* method);
 void oms_logToStdStream(int useStdStream);
 
+/**
+ * \brief Sets the linear solver of CVODE for an ME FMU instance.
+ *
+ * "dense" (default) uses a dense direct solver with the internal difference
+ * quotients of CVODE, "klu" a sparse direct solver (only if built with
+ * OMS_WITH_KLU) and "spgmr" a Krylov solver with a banded preconditioner. For
+ * "klu", the Jacobian is evaluated column group by column group based on the
+ * sparsity pattern of the model structure.
+ *
+ * @param model        [in] Model as opaque pointer.
+ * @param instanceName [in] Name of the FMU instance.
+ * @param solver       [in] Name of the linear solver.
+ */
+void oms_setLinearSolver(void* model, const char* instanceName, const char* solver);
+
+/**
+ * \brief Sets the communication interval of a single FMU instance.
+ *
+ * The master steps with the shortest communication interval. An instance
+ * with a longer interval is only stepped at its own communication points
+ * and holds its inputs in between. Intervals that aren't multiples of the
+ * master's interval are rounded up to the next communication point of the
+ * master.
+ *
+ * @param model                 [in] Model as opaque pointer.
+ * @param instanceName          [in] Name of the FMU instance.
+ * @param communicationInterval [in] Communication interval or 0 for the one of the model.
+ * @return Error status.
+ */
+oms_status_t oms_setInstanceCommunicationInterval(void* model, const char* instanceName, double communicationInterval);
+
+/**
+ * \brief Sets a solver option of an ME FMU instance.
+ *
+ * Available options are "maxNumSteps" (default 1000), "maxNonlinIters"
+ * (default 5), "initialStepSize" (default 1e-6), "minimalStepSize" (default
+ * 1e-12), "maximalStepSize" (default (stopTime-startTime)/10) and
+ * "absoluteToleranceFactor" (default 0.01). The absolute tolerance of a state
+ * is the factor times the relative tolerance times the nominal value of the
+ * state. Only "initialStepSize" is also used by dopri5.
+ *
+ * @param model        [in] Model as opaque pointer.
+ * @param instanceName [in] Name of the FMU instance.
+ * @param option       [in] Name of the solver option.
+ * @param value        [in] Value of the solver option.
+ * @return Error status.
+ */
+oms_status_t oms_setSolverOption(void* model, const char* instanceName, const char* option, double value);
+
+/**
+ * \brief Returns the solver statistics of an ME FMU instance.
+ *
+ * The statistics are accumulated since the initialization and are still
+ * available after the model was terminated.
+ *
+ * @param model        [in]  Model as opaque pointer.
+ * @param instanceName [in]  Name of the FMU instance.
+ * @param statistics   [out] Solver statistics.
+ * @return Error status.
+ */
+oms_status_t oms_getSolverStatistics(void* model, const char* instanceName, oms_solver_statistics_t* statistics);
+
+/**
+ * \brief Sets the number of threads that are used to step the FMU instances.
+ *
+ * All instances are stepped concurrently within one communication interval.
+ * Use 1 (default) for serial stepping.
+ *
+ * @param model    [in] Model as opaque pointer.
+ * @param numProcs [in] Number of threads.
+ */
+void oms_setNumProcs(void* model, int numProcs);
+
+/**
+ * \brief Selects the solver for algebraic loops between FMUs.
+ *
+ * Available solvers are "fixedpoint" (default) and "kinsol" (Newton method).
+ *
+ * @param model  [in] Model as opaque pointer.
+ * @param solver [in] Name of the solver.
+ */
+void oms_setAlgLoopSolver(void* model, const char* solver);
+
+/**
+ * \brief Sets the master algorithm.
+ *
+ * "jacobi" (default) steps all instances with the inputs of the last
+ * communication point. "gaussseidel" steps the instances in dependency
+ * order and passes fresh outputs to the downstream instances before they
+ * step. The instances are then stepped sequentially.
+ *
+ * @param model     [in] Model as opaque pointer.
+ * @param algorithm [in] Name of the master algorithm.
+ */
+void oms_setMasterAlgorithm(void* model, const char* algorithm);
+
+/**
+ * \brief Enables asynchronous writing of the result file.
+ *
+ * The result file is then written by a separate I/O thread and the
+ * simulation only swaps buffers.
+ *
+ * @param model           [in] Model as opaque pointer.
+ * @param asyncResultFile [in] true to enable, false (default) to disable.
+ */
+void oms_setAsyncResultFile(void* model, int asyncResultFile);
+
+/**
+ * \brief Enables an adaptive communication step size.
+ *
+ * The macro step then starts at the communication interval and is scaled
+ * by an estimate of the coupling error of the exchanged outputs.
+ *
+ * @param model            [in] Model as opaque pointer.
+ * @param adaptiveStepSize [in] true to enable, false (default) to disable.
+ */
+void oms_setAdaptiveStepSize(void* model, int adaptiveStepSize);
+
+/**
+ * \brief Sets the bounds of the adaptive communication step size.
+ *
+ * @param model           [in] Model as opaque pointer.
+ * @param minimalStepSize [in] Minimal step size (default 1e-6).
+ * @param maximalStepSize [in] Maximal step size (default 1.0).
+ */
+void oms_setStepSizeBounds(void* model, double minimalStepSize, double maximalStepSize);
+
+/**
+ * \brief Sets the relative tolerance of the coupling error estimate.
+ *
+ * @param model             [in] Model as opaque pointer.
+ * @param couplingTolerance [in] Relative tolerance (default 1e-4).
+ */
+void oms_setCouplingTolerance(void* model, double couplingTolerance);
+
+/**
+ * \brief Enables or disables the recording of all time measurements.
+ *
+ * If enabled, each tic/toc of the internal clocks is recorded with thread
+ * and FMU instance and can be exported using oms_exportTrace.
+ *
+ * @param enable [in] true to enable, false (default) to disable.
+ */
+void oms_setTracing(int enable);
+
+/**
+ * \brief Exports the recorded time measurements.
+ *
+ * The file uses the Chrome trace event format, which can be viewed with
+ * chrome://tracing or Perfetto.
+ *
+ * @param filename [in] Name of the trace file, e.g. "trace.json".
+ * @return Error status.
+ */
+oms_status_t oms_exportTrace(const char* filename);
+
 /**
  * \brief Returns the library's version string.
  *
@@ -30,18 +30,53 @@
  */
 
 #include "ResultWriter.h"
+#include "Logging.h"
 
 ResultWriter::ResultWriter(unsigned int bufferSize)
   : bufferSize(bufferSize),
-    nEmits(0),
-    data_2(NULL)
+    nReals(0),
+    nInts(0),
+    nBools(0),
+    numberOfBuffers(0),
+    stop(false)
 {
+  buffer.data_2 = NULL;
+  buffer.data_3 = NULL;
+  buffer.data_4 = NULL;
+  buffer.nRows = 0;
 }
 
 ResultWriter::~ResultWriter()
 {
-  if (data_2)
-    delete[] data_2;
+  if (writer.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+    }
+    bufferFull.notify_all();
+    writer.join();
+  }
+
+  freeBuffers();
+}
+
+/**
+ * Enables the asynchronous mode using the given number of buffers (>= 2).
+ * The buffers are written to disk by a dedicated I/O thread. This has to be
+ * called before create().
+ */
+void ResultWriter::setAsync(unsigned int numberOfBuffers)
+{
+  if (buffer.data_2)
+  {
+    logWarning("ResultWriter::setAsync: result file is already created");
+    return;
+  }
+
+  if (numberOfBuffers < 2 && numberOfBuffers != 0)
+    numberOfBuffers = 2;
+  this->numberOfBuffers = numberOfBuffers;
 }
 
 unsigned int ResultWriter::addSignal(const std::string& name, const std::string& description, SignalType_t type)
@@ -52,6 +87,19 @@ unsigned int ResultWriter::addSignal(const std::string& name, const std::string&
   signal.type = type;
 
   signals.push_back(signal);
+  switch (type)
+  {
+  case SignalType_REAL:
+    columns.push_back(1 + nReals++);
+    break;
+  case SignalType_INT:
+    columns.push_back(nInts++);
+    break;
+  case SignalType_BOOL:
+    columns.push_back(nBools++);
+    break;
+  }
+
   return (unsigned int) signals.size();
 }
 
@@ -71,44 +119,182 @@ bool ResultWriter::create(const std::string& filename, double startTime, double
   if (!createFile(filename, startTime, stopTime))
     return false;
 
-  data_2 = new double[bufferSize*(signals.size() + 1)];
-  nEmits = 0;
+  unsigned int n = numberOfBuffers > 0 ? numberOfBuffers : 1;
+  for (int i=0; i<n; ++i)
+  {
+    Buffer b;
+    b.data_2 = new double[bufferSize*(nReals + 1)];
+    b.data_3 = nInts > 0 ? new int32_t[bufferSize*nInts] : NULL;
+    b.data_4 = nBools > 0 ? new uint8_t[bufferSize*nBools] : NULL;
+    b.nRows = 0;
+    buffers.push_back(b);
+  }
+
+  buffer = buffers[0];
+  if (numberOfBuffers > 0)
+  {
+    emptyBuffers.assign(buffers.begin() + 1, buffers.end());
+    stop = false;
+    writer = std::thread(&ResultWriter::ioThread, this);
+  }
   return true;
 }
 
 void ResultWriter::close()
 {
-  closeFile();
-
-  if (data_2)
+  if (buffer.data_2)
   {
-    delete[] data_2;
-    data_2 = NULL;
+    if (writer.joinable())
+    {
+      flushBuffer();
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+      }
+      bufferFull.notify_all();
+      writer.join();
+    }
+    else if (buffer.nRows > 0)
+      writeFile(buffer);
   }
 
+  closeFile();
+  freeBuffers();
+
   signals.clear();
+  columns.clear();
   parameters.clear();
+  nReals = 0;
+  nInts = 0;
+  nBools = 0;
+}
+
+void ResultWriter::freeBuffers()
+{
+  for (int i=0; i<buffers.size(); ++i)
+  {
+    delete[] buffers[i].data_2;
+    if (buffers[i].data_3)
+      delete[] buffers[i].data_3;
+    if (buffers[i].data_4)
+      delete[] buffers[i].data_4;
+  }
+  buffers.clear();
+  emptyBuffers.clear();
+  fullBuffers.clear();
+
+  buffer.data_2 = NULL;
+  buffer.data_3 = NULL;
+  buffer.data_4 = NULL;
+  buffer.nRows = 0;
 }
 
 void ResultWriter::updateSignal(unsigned int id, SignalValue_t value)
 {
-  if (!data_2)
+  if (!buffer.data_2)
     return;
 
-  data_2[nEmits*(signals.size() + 1) + id] = value.realValue;
+  unsigned int column = columns[id - 1];
+  switch (signals[id - 1].type)
+  {
+  case SignalType_REAL:
+    buffer.data_2[buffer.nRows*(nReals + 1) + column] = value.realValue;
+    break;
+  case SignalType_INT:
+    buffer.data_3[buffer.nRows*nInts + column] = value.intValue;
+    break;
+  case SignalType_BOOL:
+    buffer.data_4[buffer.nRows*nBools + column] = value.boolValue ? 1 : 0;
+    break;
+  }
+}
+
+/**
+ * Returns the location of the given signal in the current row. Signals of
+ * the same type that were added one after another are stored contiguously,
+ * i.e. they can be written at once using the returned pointer.
+ */
+double* ResultWriter::getRealBuffer(unsigned int id)
+{
+  if (!buffer.data_2)
+    return NULL;
+  return &buffer.data_2[buffer.nRows*(nReals + 1) + columns[id - 1]];
+}
+
+int32_t* ResultWriter::getIntegerBuffer(unsigned int id)
+{
+  if (!buffer.data_3)
+    return NULL;
+  return &buffer.data_3[buffer.nRows*nInts + columns[id - 1]];
+}
+
+uint8_t* ResultWriter::getBooleanBuffer(unsigned int id)
+{
+  if (!buffer.data_4)
+    return NULL;
+  return &buffer.data_4[buffer.nRows*nBools + columns[id - 1]];
 }
 
 void ResultWriter::emit(double time)
 {
-  if (!data_2)
+  if (!buffer.data_2)
     return;
 
-  data_2[nEmits*(signals.size() + 1) + 0] = time;
-  nEmits++;
+  buffer.data_2[buffer.nRows*(nReals + 1) + 0] = time;
+  buffer.nRows++;
 
-  if (nEmits >= bufferSize)
+  if (buffer.nRows >= bufferSize)
   {
-    writeFile();
-    nEmits = 0;
+    if (writer.joinable())
+      flushBuffer();
+    else
+    {
+      writeFile(buffer);
+      buffer.nRows = 0;
+    }
+  }
+}
+
+/**
+ * Hands the current buffer over to the I/O thread and continues with the
+ * next free one. This only blocks if the I/O thread falls behind by more
+ * than numberOfBuffers-1 buffers.
+ */
+void ResultWriter::flushBuffer()
+{
+  if (buffer.nRows == 0)
+    return;
+
+  std::unique_lock<std::mutex> lock(mutex);
+  fullBuffers.push_back(buffer);
+  bufferFull.notify_one();
+
+  bufferFree.wait(lock, [this] {return !emptyBuffers.empty();});
+  buffer = emptyBuffers.front();
+  emptyBuffers.pop_front();
+  buffer.nRows = 0;
+}
+
+void ResultWriter::ioThread()
+{
+  while (true)
+  {
+    Buffer b;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      bufferFull.wait(lock, [this] {return stop || !fullBuffers.empty();});
+      if (fullBuffers.empty())
+        return;
+      b = fullBuffers.front();
+      fullBuffers.pop_front();
+    }
+
+    writeFile(b);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      emptyBuffers.push_back(b);
+    }
+    bufferFree.notify_one();
   }
 }
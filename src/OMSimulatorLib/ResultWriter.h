@@ -32,8 +32,13 @@
 #ifndef _OMS_RESULTWRITER_H_
 #define _OMS_RESULTWRITER_H_
 
+#include <stdint.h>
 #include <string>
 #include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 enum SignalType_t
 {
@@ -71,28 +76,68 @@ public:
   unsigned int addSignal(const std::string& name, const std::string& description, SignalType_t type);
   void addParameter(const std::string& name, const std::string& description, SignalType_t type, SignalValue_t value);
 
+  void setAsync(unsigned int numberOfBuffers);
+
   bool create(const std::string& filename, double startTime, double stopTime);
   void close();
 
   void updateSignal(unsigned int id, SignalValue_t value);
+  double* getRealBuffer(unsigned int id);
+  int32_t* getIntegerBuffer(unsigned int id);
+  uint8_t* getBooleanBuffer(unsigned int id);
   void emit(double time);
 
+private:
+  void flushBuffer();
+  void ioThread();
+  void freeBuffers();
+
 private:
   // Stop the compiler generating methods for copying the object
   ResultWriter(ResultWriter const& copy);            // Not Implemented
   ResultWriter& operator=(ResultWriter const& copy); // Not Implemented
 
 protected:
+  /**
+   * Each signal is stored at its native width in the table of its type,
+   * row by row: data_2 holds time and all real signals, data_3 all integer
+   * signals and data_4 all boolean signals.
+   */
+  struct Buffer
+  {
+    double* data_2;
+    int32_t* data_3;
+    uint8_t* data_4;
+    unsigned int nRows;
+  };
+
   virtual bool createFile(const std::string& filename, double startTime, double stopTime) = 0;
   virtual void closeFile() = 0;
-  virtual void writeFile() = 0;
+  virtual void writeFile(const Buffer& buffer) = 0;
 
   std::vector<Signal> signals;
+  std::vector<unsigned int> columns; ///< column of each signal within the table of its type
   std::vector<Parameter> parameters;
 
-  double* data_2;
+  unsigned int nReals;
+  unsigned int nInts;
+  unsigned int nBools;
+
+  Buffer buffer;
   unsigned int bufferSize;
-  unsigned int nEmits;
+
+private:
+  // asynchronous mode: the simulation thread fills a buffer and hands it
+  // over to the I/O thread as soon as it is full
+  unsigned int numberOfBuffers;
+  std::vector<Buffer> buffers;
+  std::deque<Buffer> emptyBuffers;
+  std::deque<Buffer> fullBuffers;
+  std::thread writer;
+  std::mutex mutex;
+  std::condition_variable bufferFull;
+  std::condition_variable bufferFree;
+  bool stop;
 };
 
 #endif
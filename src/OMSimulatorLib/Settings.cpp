@@ -42,6 +42,14 @@ Settings::Settings()
   tolerance = 1e-4;
   communicationInterval = 1e-1;
   resultFile = NULL;
+  numProcs = 1;
+  algLoopSolver = FIXEDPOINT;
+  masterAlgorithm = JACOBI;
+  asyncResultFile = false;
+  adaptiveStepSize = false;
+  minimalStepSize = 1e-6;
+  maximalStepSize = 1.0;
+  couplingTolerance = 1e-4;
 }
 
 Settings::~Settings()
@@ -84,3 +92,54 @@ void Settings::ClearResultFile()
     resultFile = NULL;
   }
 }
+
+void Settings::SetNumProcs(unsigned int numProcs)
+{
+  if (numProcs < 1)
+  {
+    logWarning("Settings::SetNumProcs: invalid number of threads (" + std::to_string(numProcs) + "), using 1 instead");
+    numProcs = 1;
+  }
+  this->numProcs = numProcs;
+}
+
+void Settings::SetAlgLoopSolver(AlgLoopSolver_t algLoopSolver)
+{
+  this->algLoopSolver = algLoopSolver;
+}
+
+void Settings::SetMasterAlgorithm(MasterAlgorithm_t masterAlgorithm)
+{
+  this->masterAlgorithm = masterAlgorithm;
+}
+
+void Settings::SetAsyncResultFile(bool asyncResultFile)
+{
+  this->asyncResultFile = asyncResultFile;
+}
+
+void Settings::SetAdaptiveStepSize(bool adaptiveStepSize)
+{
+  this->adaptiveStepSize = adaptiveStepSize;
+}
+
+void Settings::SetStepSizeBounds(double minimalStepSize, double maximalStepSize)
+{
+  if (minimalStepSize <= 0.0 || maximalStepSize < minimalStepSize)
+  {
+    logWarning("Settings::SetStepSizeBounds: invalid bounds [" + std::to_string(minimalStepSize) + ", " + std::to_string(maximalStepSize) + "], keeping [" + std::to_string(this->minimalStepSize) + ", " + std::to_string(this->maximalStepSize) + "]");
+    return;
+  }
+  this->minimalStepSize = minimalStepSize;
+  this->maximalStepSize = maximalStepSize;
+}
+
+void Settings::SetCouplingTolerance(double couplingTolerance)
+{
+  if (couplingTolerance <= 0.0)
+  {
+    logWarning("Settings::SetCouplingTolerance: invalid tolerance (" + std::to_string(couplingTolerance) + "), keeping " + std::to_string(this->couplingTolerance));
+    return;
+  }
+  this->couplingTolerance = couplingTolerance;
+}
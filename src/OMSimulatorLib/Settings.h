@@ -35,6 +35,9 @@
 class Settings
 {
 public:
+  enum AlgLoopSolver_t { FIXEDPOINT, KINSOL };
+  enum MasterAlgorithm_t { JACOBI, GAUSS_SEIDEL };
+
   Settings();
   ~Settings();
 
@@ -54,6 +57,28 @@ public:
   const char* GetResultFile() const {return resultFile;}
   void ClearResultFile();
 
+  void SetNumProcs(unsigned int numProcs);
+  unsigned int GetNumProcs() const {return numProcs;}
+
+  void SetAlgLoopSolver(AlgLoopSolver_t algLoopSolver);
+  AlgLoopSolver_t GetAlgLoopSolver() const {return algLoopSolver;}
+
+  void SetMasterAlgorithm(MasterAlgorithm_t masterAlgorithm);
+  MasterAlgorithm_t GetMasterAlgorithm() const {return masterAlgorithm;}
+
+  void SetAsyncResultFile(bool asyncResultFile);
+  bool GetAsyncResultFile() const {return asyncResultFile;}
+
+  void SetAdaptiveStepSize(bool adaptiveStepSize);
+  bool GetAdaptiveStepSize() const {return adaptiveStepSize;}
+
+  void SetStepSizeBounds(double minimalStepSize, double maximalStepSize);
+  double GetMinimalStepSize() const {return minimalStepSize;}
+  double GetMaximalStepSize() const {return maximalStepSize;}
+
+  void SetCouplingTolerance(double couplingTolerance);
+  double GetCouplingTolerance() const {return couplingTolerance;}
+
 private:
   // stop the compiler generating methods for copying the object
   Settings(Settings const& copy);            // not implemented
@@ -64,6 +89,14 @@ private:
   double tolerance;
   double communicationInterval;
   char* resultFile;
+  unsigned int numProcs;
+  AlgLoopSolver_t algLoopSolver;
+  MasterAlgorithm_t masterAlgorithm;
+  bool asyncResultFile;
+  bool adaptiveStepSize;
+  double minimalStepSize;
+  double maximalStepSize;
+  double couplingTolerance;
 };
 
 #endif
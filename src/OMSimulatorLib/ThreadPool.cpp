@@ -0,0 +1,95 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-CurrentYear, Open Source Modelica Consortium (OSMC),
+ * c/o Linköpings universitet, Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF GPL VERSION 3 LICENSE OR
+ * THIS OSMC PUBLIC LICENSE (OSMC-PL) VERSION 1.2.
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES
+ * RECIPIENT'S ACCEPTANCE OF THE OSMC PUBLIC LICENSE OR THE GPL VERSION 3,
+ * ACCORDING TO RECIPIENTS CHOICE.
+ *
+ * The OpenModelica software and the Open Source Modelica
+ * Consortium (OSMC) Public License (OSMC-PL) are obtained
+ * from OSMC, either from the above address,
+ * from the URLs: http://www.ida.liu.se/projects/OpenModelica or
+ * http://www.openmodelica.org, and in the OpenModelica distribution.
+ * GNU version 3 is obtained from: http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without
+ * even the implied warranty of  MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE, EXCEPT AS EXPRESSLY SET FORTH
+ * IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE CONDITIONS OF OSMC-PL.
+ *
+ * See the full OSMC Public License conditions for more details.
+ *
+ */
+
+#include "ThreadPool.h"
+#include "Logging.h"
+
+ThreadPool::ThreadPool(unsigned int numThreads)
+  : pendingTasks(0), stop(false)
+{
+  logTrace();
+  for (unsigned int i=0; i<numThreads; ++i)
+    workers.push_back(std::thread(&ThreadPool::worker, this));
+}
+
+ThreadPool::~ThreadPool()
+{
+  logTrace();
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    stop = true;
+  }
+  taskAvailable.notify_all();
+
+  for (unsigned int i=0; i<workers.size(); ++i)
+    workers[i].join();
+}
+
+void ThreadPool::push(const std::function<void()>& task)
+{
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    tasks.push(task);
+    pendingTasks++;
+  }
+  taskAvailable.notify_one();
+}
+
+void ThreadPool::wait()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  allTasksDone.wait(lock, [this] {return 0 == pendingTasks;});
+}
+
+void ThreadPool::worker()
+{
+  while (true)
+  {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      taskAvailable.wait(lock, [this] {return stop || !tasks.empty();});
+      if (stop && tasks.empty())
+        return;
+      task = tasks.front();
+      tasks.pop();
+    }
+
+    task();
+
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      pendingTasks--;
+      if (0 == pendingTasks)
+        allTasksDone.notify_all();
+    }
+  }
+}
@@ -0,0 +1,77 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-CurrentYear, Open Source Modelica Consortium (OSMC),
+ * c/o Linköpings universitet, Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF GPL VERSION 3 LICENSE OR
+ * THIS OSMC PUBLIC LICENSE (OSMC-PL) VERSION 1.2.
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES
+ * RECIPIENT'S ACCEPTANCE OF THE OSMC PUBLIC LICENSE OR THE GPL VERSION 3,
+ * ACCORDING TO RECIPIENTS CHOICE.
+ *
+ * The OpenModelica software and the Open Source Modelica
+ * Consortium (OSMC) Public License (OSMC-PL) are obtained
+ * from OSMC, either from the above address,
+ * from the URLs: http://www.ida.liu.se/projects/OpenModelica or
+ * http://www.openmodelica.org, and in the OpenModelica distribution.
+ * GNU version 3 is obtained from: http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without
+ * even the implied warranty of  MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE, EXCEPT AS EXPRESSLY SET FORTH
+ * IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE CONDITIONS OF OSMC-PL.
+ *
+ * See the full OSMC Public License conditions for more details.
+ *
+ */
+
+#ifndef _OMS_THREAD_POOL_H_
+#define _OMS_THREAD_POOL_H_
+
+#include <functional>
+#include <queue>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * \brief Fixed-size pool of worker threads.
+ *
+ * Tasks are pushed to a shared queue and executed by the next free worker.
+ * wait() blocks until all pushed tasks are finished.
+ */
+class ThreadPool
+{
+public:
+  ThreadPool(unsigned int numThreads);
+  ~ThreadPool();
+
+  void push(const std::function<void()>& task);
+  void wait();
+
+  unsigned int size() const {return workers.size();}
+
+private:
+  void worker();
+
+private:
+  std::vector<std::thread> workers;
+  std::queue< std::function<void()> > tasks;
+  std::mutex mutex;
+  std::condition_variable taskAvailable;
+  std::condition_variable allTasksDone;
+  unsigned int pendingTasks;
+  bool stop;
+
+private:
+  // Stop the compiler generating methods of copy the object
+  ThreadPool(ThreadPool const& copy);            // Not Implemented
+  ThreadPool& operator=(ThreadPool const& copy); // Not Implemented
+};
+
+#endif
@@ -0,0 +1,148 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-CurrentYear, Open Source Modelica Consortium (OSMC),
+ * c/o Linköpings universitet, Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF GPL VERSION 3 LICENSE OR
+ * THIS OSMC PUBLIC LICENSE (OSMC-PL) VERSION 1.2.
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES
+ * RECIPIENT'S ACCEPTANCE OF THE OSMC PUBLIC LICENSE OR THE GPL VERSION 3,
+ * ACCORDING TO RECIPIENTS CHOICE.
+ *
+ * The OpenModelica software and the Open Source Modelica
+ * Consortium (OSMC) Public License (OSMC-PL) are obtained
+ * from OSMC, either from the above address,
+ * from the URLs: http://www.ida.liu.se/projects/OpenModelica or
+ * http://www.openmodelica.org, and in the OpenModelica distribution.
+ * GNU version 3 is obtained from: http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without
+ * even the implied warranty of  MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE, EXCEPT AS EXPRESSLY SET FORTH
+ * IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE CONDITIONS OF OSMC-PL.
+ *
+ * See the full OSMC Public License conditions for more details.
+ *
+ */
+
+#include "Timeline.h"
+#include "Logging.h"
+
+#include <stdio.h>
+
+#define OMS_TIMELINE_BUFFER_SIZE 65536
+
+Timeline& Timeline::getInstance()
+{
+  // The only instance
+  static Timeline instance;
+  return instance;
+}
+
+Timeline::Timeline()
+  : enabled(false)
+{
+  startTime = std::chrono::steady_clock::now();
+  owners.push_back("OMSimulator");
+}
+
+Timeline::~Timeline()
+{
+  for (int i=0; i<threadBuffers.size(); ++i)
+    delete threadBuffers[i];
+}
+
+void Timeline::SetEnabled(bool enabled)
+{
+  this->enabled.store(enabled);
+}
+
+/**
+ * Owners are identified by an index, so that events stay valid even if the
+ * owner (e.g. an FMU instance) is already gone when the trace is exported.
+ */
+unsigned int Timeline::registerOwner(const std::string& owner)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  for (unsigned int i=0; i<owners.size(); ++i)
+    if (owners[i] == owner)
+      return i;
+  owners.push_back(owner);
+  return owners.size() - 1;
+}
+
+Timeline::ThreadBuffer* Timeline::getThreadBuffer()
+{
+  static thread_local ThreadBuffer* buffer = NULL;
+  if (!buffer)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    buffer = new ThreadBuffer();
+    buffer->tid = threadBuffers.size();
+    buffer->events.resize(OMS_TIMELINE_BUFFER_SIZE);
+    buffer->head.store(0);
+    threadBuffers.push_back(buffer);
+  }
+  return buffer;
+}
+
+void Timeline::record(char phase, const char* name, unsigned int owner)
+{
+  if (!IsEnabled())
+    return;
+
+  ThreadBuffer* buffer = getThreadBuffer();
+  uint64_t head = buffer->head.load(std::memory_order_relaxed);
+  Event& event = buffer->events[head % OMS_TIMELINE_BUFFER_SIZE];
+  event.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+  event.name = name;
+  event.owner = owner;
+  event.phase = phase;
+  buffer->head.store(head + 1, std::memory_order_release);
+}
+
+/**
+ * Writes all recorded events in the Chrome trace event format. Events that
+ * are recorded concurrently to the export might be incomplete, hence this
+ * should be called while the model isn't simulated.
+ */
+bool Timeline::exportTrace(const std::string& filename)
+{
+  FILE* pFile = fopen(filename.c_str(), "w");
+  if (!pFile)
+  {
+    logError("Timeline::exportTrace: Couldn't open file " + filename);
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  fprintf(pFile, "{\"traceEvents\":[\n");
+  bool first = true;
+  for (int i=0; i<threadBuffers.size(); ++i)
+  {
+    ThreadBuffer* buffer = threadBuffers[i];
+    uint64_t head = buffer->head.load(std::memory_order_acquire);
+    uint64_t tail = head > OMS_TIMELINE_BUFFER_SIZE ? head - OMS_TIMELINE_BUFFER_SIZE : 0;
+
+    for (uint64_t j=tail; j<head; ++j)
+    {
+      const Event& event = buffer->events[j % OMS_TIMELINE_BUFFER_SIZE];
+      fprintf(pFile, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%lld,\"pid\":%u,\"tid\":%u}", first ? "" : ",\n", event.name, owners[event.owner].c_str(), event.phase, (long long)event.timestamp, event.owner, buffer->tid);
+      first = false;
+    }
+  }
+
+  // name the processes after the owners
+  for (unsigned int i=0; i<owners.size(); ++i)
+  {
+    fprintf(pFile, "%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"args\":{\"name\":\"%s\"}}", first ? "" : ",\n", i, owners[i].c_str());
+    first = false;
+  }
+  fprintf(pFile, "\n]}\n");
+  fclose(pFile);
+  return true;
+}
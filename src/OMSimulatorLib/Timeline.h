@@ -0,0 +1,96 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-CurrentYear, Open Source Modelica Consortium (OSMC),
+ * c/o Linköpings universitet, Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF GPL VERSION 3 LICENSE OR
+ * THIS OSMC PUBLIC LICENSE (OSMC-PL) VERSION 1.2.
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES
+ * RECIPIENT'S ACCEPTANCE OF THE OSMC PUBLIC LICENSE OR THE GPL VERSION 3,
+ * ACCORDING TO RECIPIENTS CHOICE.
+ *
+ * The OpenModelica software and the Open Source Modelica
+ * Consortium (OSMC) Public License (OSMC-PL) are obtained
+ * from OSMC, either from the above address,
+ * from the URLs: http://www.ida.liu.se/projects/OpenModelica or
+ * http://www.openmodelica.org, and in the OpenModelica distribution.
+ * GNU version 3 is obtained from: http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without
+ * even the implied warranty of  MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE, EXCEPT AS EXPRESSLY SET FORTH
+ * IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE CONDITIONS OF OSMC-PL.
+ *
+ * See the full OSMC Public License conditions for more details.
+ *
+ */
+
+#ifndef _OMS_TIMELINE_H_
+#define _OMS_TIMELINE_H_
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * \brief Records the tic/toc events of all clocks with thread and owner.
+ *
+ * Each thread writes to its own ring buffer, i.e. recording doesn't need
+ * any locks. Only the first event of a new thread registers its buffer.
+ * If a buffer overflows, the oldest events of that thread are dropped.
+ * The recorded events can be exported in the Chrome trace event format
+ * (chrome://tracing, Perfetto).
+ */
+class Timeline
+{
+public:
+  static Timeline& getInstance();
+
+  void SetEnabled(bool enabled);
+  bool IsEnabled() const {return enabled.load(std::memory_order_relaxed);}
+
+  unsigned int registerOwner(const std::string& owner);
+  void record(char phase, const char* name, unsigned int owner);
+
+  bool exportTrace(const std::string& filename);
+
+private:
+  Timeline();
+  ~Timeline();
+
+  // Stop the compiler generating methods of copy the object
+  Timeline(Timeline const& copy);            // Not Implemented
+  Timeline& operator=(Timeline const& copy); // Not Implemented
+
+  struct Event
+  {
+    int64_t timestamp; ///< micro seconds since the timeline was created
+    const char* name;  ///< has to be a static string
+    unsigned int owner;
+    char phase;        ///< 'B' (begin) or 'E' (end)
+  };
+
+  struct ThreadBuffer
+  {
+    unsigned int tid;
+    std::vector<Event> events;
+    std::atomic<uint64_t> head;
+  };
+
+  ThreadBuffer* getThreadBuffer();
+
+  std::atomic<bool> enabled;
+  std::chrono::steady_clock::time_point startTime;
+  std::mutex mutex;
+  std::vector<ThreadBuffer*> threadBuffers;
+  std::vector<std::string> owners;
+};
+
+#endif
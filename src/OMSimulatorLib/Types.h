@@ -60,6 +60,16 @@ typedef enum {
   oms_causality_undefined,
 } oms_causality_t;
 
+/** solver statistics of an FMU instance */
+typedef struct {
+  long int numSteps;
+  long int numRhsEvals;
+  long int numLinSolvSetups;
+  long int numNonlinSolvIters;
+  long int numNonlinSolvConvFails;
+  long int numErrTestFails;
+} oms_solver_statistics_t;
+
 #ifdef __cplusplus
 }
 #endif
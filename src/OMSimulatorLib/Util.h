@@ -37,6 +37,10 @@
 #include <algorithm>
 #include <cctype>
 #include <locale>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <stdint.h>
 
 // trim from start (in place)
 // https://stackoverflow.com/a/217605/7534030
@@ -60,6 +64,84 @@ static inline void trim(std::string &s)
   rtrim(s);
 }
 
+// hash and equality of zero-terminated strings, e.g. for hash maps that
+// refer to strings owned by someone else instead of copying them
+struct CStrHash
+{
+  size_t operator()(const char* s) const
+  {
+    // FNV-1a
+    size_t hash = (size_t)14695981039346656037ULL;
+    for (; *s; ++s)
+    {
+      hash ^= (unsigned char)*s;
+      hash *= (size_t)1099511628211ULL;
+    }
+    return hash;
+  }
+};
+
+struct CStrEqual
+{
+  bool operator()(const char* a, const char* b) const {return 0 == strcmp(a, b);}
+};
+
+// raw binary I/O of plain values and vectors, e.g. for snapshots
+template<typename T>
+static inline void writeBinary(std::ostream& stream, const T& value)
+{
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+static inline bool readBinary(std::istream& stream, T& value)
+{
+  return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+template<typename T>
+static inline void writeBinary(std::ostream& stream, const std::vector<T>& values)
+{
+  writeBinary(stream, (uint64_t)values.size());
+  if (!values.empty())
+    stream.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+template<typename T>
+static inline bool readBinary(std::istream& stream, std::vector<T>& values)
+{
+  uint64_t size;
+  if (!readBinary(stream, size))
+    return false;
+
+  // a corrupted length must not be used to allocate memory
+  std::streampos pos = stream.tellg();
+  uint64_t available = (uint64_t)1 << 30; // for streams without positioning
+  if (pos != std::streampos(-1))
+  {
+    stream.seekg(0, std::ios::end);
+    available = static_cast<uint64_t>(stream.tellg() - pos);
+    stream.seekg(pos);
+  }
+  if (size > available / sizeof(T))
+  {
+    stream.setstate(std::ios::failbit);
+    return false;
+  }
+
+  values.resize(size);
+  return size == 0 || static_cast<bool>(stream.read(reinterpret_cast<char*>(values.data()), size * sizeof(T)));
+}
+
+// unlike std::to_string, keeps all digits of small values, e.g. for XML export
+static inline std::string toExactString(double value)
+{
+  std::ostringstream ss;
+  ss.precision(17);
+  ss << value;
+  return ss.str();
+}
+
 const double DOUBLEEQUAL_ABSTOL = 1e-10;
 const double DOUBLEEQUAL_RELTOL = 1e-5;
 
@@ -41,20 +41,26 @@
 #include <iostream>
 #include <string>
 
-Variable::Variable(fmi2_import_variable_t *var, FMUWrapper* fmuInstance)
-  : fmuInstance(fmuInstance), is_state(false)
+Variable::Variable(fmi2_import_variable_t *var, FMUWrapper* fmuInstance, unsigned int nameIndex)
+  : fmuInstance(fmuInstance), nameIndex(nameIndex), is_state(false)
 {
   // extract the attributes
-  name = fmi2_import_get_variable_name(var);
+  names = &fmuInstance->getVariableNames();
   description = fmi2_import_get_variable_description(var) ? fmi2_import_get_variable_description(var) : "";
   trim(description);
-  fmuInstanceName = fmuInstance->getFMUInstanceName();
+  fmuInstanceName = &fmuInstance->getFMUInstanceName();
   vr = fmi2_import_get_variable_vr(var);
   causality = fmi2_import_get_causality(var);
   initialProperty = fmi2_import_get_initial(var);
   baseType = fmi2_import_get_variable_base_type(var);
 }
 
+Variable::Variable(const std::vector<std::string>* names, unsigned int nameIndex, const std::string* fmuInstanceName, fmi2_value_reference_t vr, fmi2_causality_enu_t causality)
+  : names(names), nameIndex(nameIndex), fmuInstanceName(fmuInstanceName), fmuInstance(NULL), vr(vr), causality(causality),
+    initialProperty(fmi2_initial_enu_unknown), is_state(false), baseType(fmi2_base_type_real)
+{
+}
+
 Variable::~Variable()
 {
 }
@@ -66,9 +72,13 @@ const FMUWrapper* Variable::getFMUInstance() const
 
 bool operator==(const Variable& v1, const Variable& v2)
 {
-  return v1.name == v2.name &&
-    v1.fmuInstanceName == v2.fmuInstanceName &&
-    v1.vr == v2.vr;
+  if (v1.vr != v2.vr)
+    return false;
+  // variables of the same FMU instance share the name table
+  if (v1.names == v2.names)
+    return v1.nameIndex == v2.nameIndex;
+  return v1.getName() == v2.getName() &&
+    *v1.fmuInstanceName == *v2.fmuInstanceName;
 }
 bool operator!=(const Variable& v1, const Variable& v2)
 {
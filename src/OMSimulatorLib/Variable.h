@@ -41,7 +41,7 @@ class FMUWrapper;
 class Variable
 {
 public:
-  Variable(fmi2_import_variable_t *var, FMUWrapper* fmuInstance);
+  Variable(fmi2_import_variable_t *var, FMUWrapper* fmuInstance, unsigned int nameIndex);
   ~Variable();
 
   void markAsState() {is_state = true;}
@@ -64,8 +64,8 @@ public:
                               || (isCalculatedParameter())
                               || (isState() && (isApprox() || isCalculated()));}
 
-  const std::string& getName() const {return name;}
-  const std::string& getFMUInstanceName() const {return fmuInstanceName;}
+  const std::string& getName() const {return (*names)[nameIndex];}
+  const std::string& getFMUInstanceName() const {return *fmuInstanceName;}
   const FMUWrapper* getFMUInstance() const;
   fmi2_value_reference_t getValueReference() const {return vr;}
   fmi2_base_type_enu_t getBaseType() const {return baseType;}
@@ -76,9 +76,14 @@ public:
   bool isTypeBoolean() const {return fmi2_base_type_bool == baseType;}
 
 protected:
-  std::string name;
+  /// synthetic real variable without an FMU, e.g. for benchmarks of the graph algorithms
+  Variable(const std::vector<std::string>* names, unsigned int nameIndex, const std::string* fmuInstanceName, fmi2_value_reference_t vr, fmi2_causality_enu_t causality);
+
+protected:
+  const std::vector<std::string>* names; ///< name table owned by the FMU instance
+  unsigned int nameIndex;
   std::string description;
-  std::string fmuInstanceName;
+  const std::string* fmuInstanceName; ///< owned by the FMU instance
   FMUWrapper* fmuInstance;
   fmi2_value_reference_t vr;
   fmi2_causality_enu_t causality;
@@ -4,6 +4,8 @@
 
 #include <OMSimulator.h>
 
+#include <stdlib.h>
+
 #define REGISTER_LUA_CALL(name) lua_register(L, #name, OMSimulatorLua_##name)
 
 #ifdef _WIN32
@@ -24,6 +26,23 @@ void* topointer(lua_State *L, int index)
   return *bp;
 }
 
+/* number of elements of the array part of the table at the given index */
+int arraylength(lua_State *L, int index)
+{
+  int n = 0;
+  while (1)
+  {
+    int isNil;
+    lua_rawgeti(L, index, n+1);
+    isNil = lua_type(L, -1) == LUA_TNIL;
+    lua_pop(L, 1);
+    if (isNil)
+      break;
+    n++;
+  }
+  return n;
+}
+
 //void* oms_newModel();
 static int OMSimulatorLua_newModel(lua_State *L)
 {
@@ -48,6 +67,19 @@ static int OMSimulatorLua_loadModel(lua_State *L)
   return 1;
 }
 
+//void* oms_cloneModel(void* model);
+static int OMSimulatorLua_cloneModel(lua_State *L)
+{
+  if (lua_gettop(L) != 1)
+    return luaL_error(L, "expecting exactly 1 argument");
+  luaL_checktype(L, 1, LUA_TUSERDATA);
+
+  void *model = topointer(L, 1);
+  void *pModel = oms_cloneModel(model);
+  push_pointer(L, pModel);
+  return 1;
+}
+
 //void oms_unload(void* model);
 static int OMSimulatorLua_unload(lua_State *L)
 {
@@ -125,6 +157,203 @@ static int OMSimulatorLua_setBoolean(lua_State *L)
 }
 // TODO: setString
 
+//int oms_getVariableHandle(void* model, const char* var);
+static int OMSimulatorLua_getVariableHandle(lua_State *L)
+{
+  if (lua_gettop(L) != 2)
+    return luaL_error(L, "expecting exactly 2 arguments");
+  luaL_checktype(L, 1, LUA_TUSERDATA);
+  luaL_checktype(L, 2, LUA_TSTRING);
+
+  void *model = topointer(L, 1);
+  const char *var = lua_tostring(L, 2);
+  int handle = oms_getVariableHandle(model, var);
+  lua_pushinteger(L, handle);
+  return 1;
+}
+
+//oms_status_t oms_setRealByHandle(void* model, int handle, double value);
+static int OMSimulatorLua_setRealByHandle(lua_State *L)
+{
+  if (lua_gettop(L) != 3)
+    return luaL_error(L, "expecting exactly 3 arguments");
+  luaL_checktype(L, 1, LUA_TUSERDATA);
+  luaL_checktype(L, 2, LUA_TNUMBER);
+  luaL_checktype(L, 3, LUA_TNUMBER);
+
+  void *model = topointer(L, 1);
+  int handle = lua_tointeger(L, 2);
+  double value = lua_tonumber(L, 3);
+  oms_status_t returnValue = oms_setRealByHandle(model, handle, value);
+  lua_pushinteger(L, returnValue);
+  return 1;
+}
+
+//double oms_getRealByHandle(void* model, int handle);
+static int OMSimulatorLua_getRealByHandle(lua_State *L)
+{
+  if (lua_gettop(L) != 2)
+    return luaL_error(L, "expecting exactly 2 arguments");
+  luaL_checktype(L, 1, LUA_TUSERDATA);
+  luaL_checktype(L, 2, LUA_TNUMBER);
+
+  void *model = topointer(L, 1);
+  int handle = lua_tointeger(L, 2);
+  double value = oms_getRealByHandle(model, handle);
+  lua_pushnumber(L, value);
+  return 1;
+}
+
+//oms_status_t oms_setReals(void* model, const int* handles, int n, const double* values);
+static int OMSimulatorLua_setReals(lua_State *L)
+{
+  int i, n;
+  int *handles;
+  double *values;
+  oms_status_t returnValue;
+
+  if (lua_gettop(L) != 3)
+    return luaL_error(L, "expecting exactly 3 arguments");
+  luaL_checktype(L, 1, LUA_TUSERDATA);
+  luaL_checktype(L, 2, LUA_TTABLE);
+  luaL_checktype(L, 3, LUA_TTABLE);
+
+  void *model = topointer(L, 1);
+  n = arraylength(L, 2);
+  if (arraylength(L, 3) != n)
+    return luaL_error(L, "expecting one value per handle");
+
+  handles = (int*)malloc(n * sizeof(int));
+  values = (double*)malloc(n * sizeof(double));
+  for (i = 0; i < n; ++i)
+  {
+    lua_rawgeti(L, 2, i+1);
+    handles[i] = lua_tointeger(L, -1);
+    lua_rawgeti(L, 3, i+1);
+    values[i] = lua_tonumber(L, -1);
+    lua_pop(L, 2);
+  }
+
+  returnValue = oms_setReals(model, handles, n, values);
+  free(handles);
+  free(values);
+  lua_pushinteger(L, returnValue);
+  return 1;
+}
+
+//oms_status_t oms_getReals(void* model, const int* handles, int n, double* values);
+static int OMSimulatorLua_getReals(lua_State *L)
+{
+  int i, n;
+  int *handles;
+  double *values;
+
+  if (lua_gettop(L) != 2)
+    return luaL_error(L, "expecting exactly 2 arguments");
+  luaL_checktype(L, 1, LUA_TUSERDATA);
+  luaL_checktype(L, 2, LUA_TTABLE);
+
+  void *model = topointer(L, 1);
+  n = arraylength(L, 2);
+
+  handles = (int*)malloc(n * sizeof(int));
+  values = (double*)malloc(n * sizeof(double));
+  for (i = 0; i < n; ++i)
+  {
+    lua_rawgeti(L, 2, i+1);
+    handles[i] = lua_tointeger(L, -1);
+    lua_pop(L, 1);
+  }
+
+  oms_getReals(model, handles, n, values);
+
+  lua_newtable(L);
+  for (i = 0; i < n; ++i)
+  {
+    lua_pushnumber(L, values[i]);
+    lua_rawseti(L, -2, i+1);
+  }
+
+  free(handles);
+  free(values);
+  return 1;
+}
+
+//oms_status_t oms_setSensitivityParameters(void* model, const int* handles, int n);
+static int OMSimulatorLua_setSensitivityParameters(lua_State *L)
+{
+  int i, n;
+  int *handles;
+  oms_status_t returnValue;
+
+  if (lua_gettop(L) != 2)
+    return luaL_error(L, "expecting exactly 2 arguments");
+  luaL_checktype(L, 1, LUA_TUSERDATA);
+  luaL_checktype(L, 2, LUA_TTABLE);
+
+  void *model = topointer(L, 1);
+  n = arraylength(L, 2);
+
+  handles = (int*)malloc(n * sizeof(int));
+  for (i = 0; i < n; ++i)
+  {
+    lua_rawgeti(L, 2, i+1);
+    handles[i] = lua_tointeger(L, -1);
+    lua_pop(L, 1);
+  }
+
+  returnValue = oms_setSensitivityParameters(model, handles, n);
+  free(handles);
+  lua_pushinteger(L, returnValue);
+  return 1;
+}
+
+//oms_status_t oms_getRealSensitivities(void* model, const int* handles, int n, double* sensitivities);
+static int OMSimulatorLua_getRealSensitivities(lua_State *L)
+{
+  int i, j, n, p;
+  int *handles;
+  double *sensitivities;
+
+  if (lua_gettop(L) != 3)
+    return luaL_error(L, "expecting exactly 3 arguments");
+  luaL_checktype(L, 1, LUA_TUSERDATA);
+  luaL_checktype(L, 2, LUA_TTABLE);
+  luaL_checktype(L, 3, LUA_TNUMBER);
+
+  void *model = topointer(L, 1);
+  n = arraylength(L, 2);
+  p = lua_tointeger(L, 3);
+
+  handles = (int*)malloc(n * sizeof(int));
+  sensitivities = (double*)calloc(n * p, sizeof(double));
+  for (i = 0; i < n; ++i)
+  {
+    lua_rawgeti(L, 2, i+1);
+    handles[i] = lua_tointeger(L, -1);
+    lua_pop(L, 1);
+  }
+
+  oms_getRealSensitivities(model, handles, n, sensitivities);
+
+  // one row per variable
+  lua_newtable(L);
+  for (i = 0; i < n; ++i)
+  {
+    lua_newtable(L);
+    for (j = 0; j < p; ++j)
+    {
+      lua_pushnumber(L, sensitivities[i*p + j]);
+      lua_rawseti(L, -2, j+1);
+    }
+    lua_rawseti(L, -2, i+1);
+  }
+
+  free(handles);
+  free(sensitivities);
+  return 1;
+}
+
 //double oms_getReal(void* model, const char* var);
 static int OMSimulatorLua_getReal(lua_State *L)
 {
@@ -203,6 +432,25 @@ static int OMSimulatorLua_simulate(lua_State *L)
   return 1;
 }
 
+//oms_status_t oms_runEnsemble(void* model, const char* parameterTable, int numWorkers, const char* resultFile);
+static int OMSimulatorLua_runEnsemble(lua_State *L)
+{
+  if (lua_gettop(L) != 4)
+    return luaL_error(L, "expecting exactly 4 arguments");
+  luaL_checktype(L, 1, LUA_TUSERDATA);
+  luaL_checktype(L, 2, LUA_TSTRING);
+  luaL_checktype(L, 3, LUA_TNUMBER);
+  luaL_checktype(L, 4, LUA_TSTRING);
+
+  void *model = topointer(L, 1);
+  const char* parameterTable = lua_tostring(L, 2);
+  int numWorkers = lua_tointeger(L, 3);
+  const char* resultFile = lua_tostring(L, 4);
+  oms_status_t returnValue = oms_runEnsemble(model, parameterTable, numWorkers, resultFile);
+  lua_pushinteger(L, returnValue);
+  return 1;
+}
+
 //oms_status_t oms_doSteps(const void* model, const int numberOfSteps);
 static int OMSimulatorLua_doSteps(lua_State *L)
 {
@@ -338,6 +586,80 @@ static int OMSimulatorLua_getCurrentTime(lua_State *L)
   return 1;
 }
 
+//void* oms_saveSnapshot(void* model);
+static int OMSimulatorLua_saveSnapshot(lua_State *L)
+{
+  if (lua_gettop(L) != 1)
+    return luaL_error(L, "expecting exactly 1 argument");
+  luaL_checktype(L, 1, LUA_TUSERDATA);
+
+  void *model = topointer(L, 1);
+  void *snapshot = oms_saveSnapshot(model);
+  push_pointer(L, snapshot);
+  return 1;
+}
+
+//oms_status_t oms_restoreSnapshot(void* model, void* snapshot);
+static int OMSimulatorLua_restoreSnapshot(lua_State *L)
+{
+  if (lua_gettop(L) != 2)
+    return luaL_error(L, "expecting exactly 2 arguments");
+  luaL_checktype(L, 1, LUA_TUSERDATA);
+  luaL_checktype(L, 2, LUA_TUSERDATA);
+
+  void *model = topointer(L, 1);
+  void *snapshot = topointer(L, 2);
+  oms_status_t returnValue = oms_restoreSnapshot(model, snapshot);
+  lua_pushinteger(L, returnValue);
+  return 1;
+}
+
+//void oms_freeSnapshot(void* model, void* snapshot);
+static int OMSimulatorLua_freeSnapshot(lua_State *L)
+{
+  if (lua_gettop(L) != 2)
+    return luaL_error(L, "expecting exactly 2 arguments");
+  luaL_checktype(L, 1, LUA_TUSERDATA);
+  luaL_checktype(L, 2, LUA_TUSERDATA);
+
+  void *model = topointer(L, 1);
+  void *snapshot = topointer(L, 2);
+  oms_freeSnapshot(model, snapshot);
+  return 0;
+}
+
+//oms_status_t oms_writeSnapshot(void* model, void* snapshot, const char* filename);
+static int OMSimulatorLua_writeSnapshot(lua_State *L)
+{
+  if (lua_gettop(L) != 3)
+    return luaL_error(L, "expecting exactly 3 arguments");
+  luaL_checktype(L, 1, LUA_TUSERDATA);
+  luaL_checktype(L, 2, LUA_TUSERDATA);
+  luaL_checktype(L, 3, LUA_TSTRING);
+
+  void *model = topointer(L, 1);
+  void *snapshot = topointer(L, 2);
+  const char* filename = lua_tostring(L, 3);
+  oms_status_t returnValue = oms_writeSnapshot(model, snapshot, filename);
+  lua_pushinteger(L, returnValue);
+  return 1;
+}
+
+//void* oms_readSnapshot(void* model, const char* filename);
+static int OMSimulatorLua_readSnapshot(lua_State *L)
+{
+  if (lua_gettop(L) != 2)
+    return luaL_error(L, "expecting exactly 2 arguments");
+  luaL_checktype(L, 1, LUA_TUSERDATA);
+  luaL_checktype(L, 2, LUA_TSTRING);
+
+  void *model = topointer(L, 1);
+  const char* filename = lua_tostring(L, 2);
+  void *snapshot = oms_readSnapshot(model, filename);
+  push_pointer(L, snapshot);
+  return 1;
+}
+
 //void oms_setTempDirectory(const char* filename);
 static int OMSimulatorLua_setTempDirectory(lua_State *L)
 {
@@ -350,6 +672,18 @@ static int OMSimulatorLua_setTempDirectory(lua_State *L)
   return 0;
 }
 
+//void oms_setPersistentFMUCache(int persistent);
+static int OMSimulatorLua_setPersistentFMUCache(lua_State *L)
+{
+  if (lua_gettop(L) != 1)
+    return luaL_error(L, "expecting exactly 1 argument");
+  luaL_checktype(L, 1, LUA_TBOOLEAN);
+
+  int persistent = lua_toboolean(L, 1);
+  oms_setPersistentFMUCache(persistent);
+  return 0;
+}
+
 //void oms_setWorkingDirectory(const char* path);
 static int OMSimulatorLua_setWorkingDirectory(lua_State *L)
 {
@@ -448,6 +782,187 @@ static int OMSimulatorLua_setSolverMethod(lua_State *L)
   return 0;
 }
 
+//void oms_setLinearSolver(void* model, const char* instanceName, const char* solver);
+static int OMSimulatorLua_setLinearSolver(lua_State *L)
+{
+  if (lua_gettop(L) != 3)
+    return luaL_error(L, "expecting exactly 3 arguments");
+  luaL_checktype(L, 1, LUA_TUSERDATA);
+  luaL_checktype(L, 2, LUA_TSTRING);
+  luaL_checktype(L, 3, LUA_TSTRING);
+
+  void *model = topointer(L, 1);
+  const char* instanceName = lua_tostring(L, 2);
+  const char* solver = lua_tostring(L, 3);
+  oms_setLinearSolver(model, instanceName, solver);
+  return 0;
+}
+
+//oms_status_t oms_setInstanceCommunicationInterval(void* model, const char* instanceName, double communicationInterval);
+static int OMSimulatorLua_setInstanceCommunicationInterval(lua_State *L)
+{
+  if (lua_gettop(L) != 3)
+    return luaL_error(L, "expecting exactly 3 arguments");
+  luaL_checktype(L, 1, LUA_TUSERDATA);
+  luaL_checktype(L, 2, LUA_TSTRING);
+  luaL_checktype(L, 3, LUA_TNUMBER);
+
+  void *model = topointer(L, 1);
+  const char* instanceName = lua_tostring(L, 2);
+  double communicationInterval = lua_tonumber(L, 3);
+  oms_status_t returnValue = oms_setInstanceCommunicationInterval(model, instanceName, communicationInterval);
+  lua_pushinteger(L, returnValue);
+  return 1;
+}
+
+//oms_status_t oms_setSolverOption(void* model, const char* instanceName, const char* option, double value);
+static int OMSimulatorLua_setSolverOption(lua_State *L)
+{
+  if (lua_gettop(L) != 4)
+    return luaL_error(L, "expecting exactly 4 arguments");
+  luaL_checktype(L, 1, LUA_TUSERDATA);
+  luaL_checktype(L, 2, LUA_TSTRING);
+  luaL_checktype(L, 3, LUA_TSTRING);
+  luaL_checktype(L, 4, LUA_TNUMBER);
+
+  void *model = topointer(L, 1);
+  const char* instanceName = lua_tostring(L, 2);
+  const char* option = lua_tostring(L, 3);
+  double value = lua_tonumber(L, 4);
+  oms_status_t returnValue = oms_setSolverOption(model, instanceName, option, value);
+  lua_pushinteger(L, returnValue);
+  return 1;
+}
+
+//oms_status_t oms_getSolverStatistics(void* model, const char* instanceName, oms_solver_statistics_t* statistics);
+static int OMSimulatorLua_getSolverStatistics(lua_State *L)
+{
+  if (lua_gettop(L) != 2)
+    return luaL_error(L, "expecting exactly 2 arguments");
+  luaL_checktype(L, 1, LUA_TUSERDATA);
+  luaL_checktype(L, 2, LUA_TSTRING);
+
+  void *model = topointer(L, 1);
+  const char* instanceName = lua_tostring(L, 2);
+  oms_solver_statistics_t statistics = {0, 0, 0, 0, 0, 0};
+  oms_getSolverStatistics(model, instanceName, &statistics);
+
+  lua_newtable(L);
+  lua_pushinteger(L, statistics.numSteps);
+  lua_setfield(L, -2, "numSteps");
+  lua_pushinteger(L, statistics.numRhsEvals);
+  lua_setfield(L, -2, "numRhsEvals");
+  lua_pushinteger(L, statistics.numLinSolvSetups);
+  lua_setfield(L, -2, "numLinSolvSetups");
+  lua_pushinteger(L, statistics.numNonlinSolvIters);
+  lua_setfield(L, -2, "numNonlinSolvIters");
+  lua_pushinteger(L, statistics.numNonlinSolvConvFails);
+  lua_setfield(L, -2, "numNonlinSolvConvFails");
+  lua_pushinteger(L, statistics.numErrTestFails);
+  lua_setfield(L, -2, "numErrTestFails");
+  return 1;
+}
+
+//void oms_setNumProcs(void* model, int numProcs);
+static int OMSimulatorLua_setNumProcs(lua_State *L)
+{
+  if (lua_gettop(L) != 2)
+    return luaL_error(L, "expecting exactly 2 arguments");
+  luaL_checktype(L, 1, LUA_TUSERDATA);
+  luaL_checktype(L, 2, LUA_TNUMBER);
+
+  void *model = topointer(L, 1);
+  int numProcs = lua_tointeger(L, 2);
+  oms_setNumProcs(model, numProcs);
+  return 0;
+}
+
+//void oms_setAlgLoopSolver(void* model, const char* solver);
+static int OMSimulatorLua_setAlgLoopSolver(lua_State *L)
+{
+  if (lua_gettop(L) != 2)
+    return luaL_error(L, "expecting exactly 2 arguments");
+  luaL_checktype(L, 1, LUA_TUSERDATA);
+  luaL_checktype(L, 2, LUA_TSTRING);
+
+  void *model = topointer(L, 1);
+  const char* solver = lua_tostring(L, 2);
+  oms_setAlgLoopSolver(model, solver);
+  return 0;
+}
+
+//void oms_setMasterAlgorithm(void* model, const char* algorithm);
+static int OMSimulatorLua_setMasterAlgorithm(lua_State *L)
+{
+  if (lua_gettop(L) != 2)
+    return luaL_error(L, "expecting exactly 2 arguments");
+  luaL_checktype(L, 1, LUA_TUSERDATA);
+  luaL_checktype(L, 2, LUA_TSTRING);
+
+  void *model = topointer(L, 1);
+  const char* algorithm = lua_tostring(L, 2);
+  oms_setMasterAlgorithm(model, algorithm);
+  return 0;
+}
+
+//void oms_setAsyncResultFile(void* model, int asyncResultFile);
+static int OMSimulatorLua_setAsyncResultFile(lua_State *L)
+{
+  if (lua_gettop(L) != 2)
+    return luaL_error(L, "expecting exactly 2 arguments");
+  luaL_checktype(L, 1, LUA_TUSERDATA);
+  luaL_checktype(L, 2, LUA_TBOOLEAN);
+
+  void *model = topointer(L, 1);
+  int asyncResultFile = lua_toboolean(L, 2);
+  oms_setAsyncResultFile(model, asyncResultFile);
+  return 0;
+}
+
+//void oms_setAdaptiveStepSize(void* model, int adaptiveStepSize);
+static int OMSimulatorLua_setAdaptiveStepSize(lua_State *L)
+{
+  if (lua_gettop(L) != 2)
+    return luaL_error(L, "expecting exactly 2 arguments");
+  luaL_checktype(L, 1, LUA_TUSERDATA);
+  luaL_checktype(L, 2, LUA_TBOOLEAN);
+
+  void *model = topointer(L, 1);
+  int adaptiveStepSize = lua_toboolean(L, 2);
+  oms_setAdaptiveStepSize(model, adaptiveStepSize);
+  return 0;
+}
+
+//void oms_setStepSizeBounds(void* model, double minimalStepSize, double maximalStepSize);
+static int OMSimulatorLua_setStepSizeBounds(lua_State *L)
+{
+  if (lua_gettop(L) != 3)
+    return luaL_error(L, "expecting exactly 3 arguments");
+  luaL_checktype(L, 1, LUA_TUSERDATA);
+  luaL_checktype(L, 2, LUA_TNUMBER);
+  luaL_checktype(L, 3, LUA_TNUMBER);
+
+  void *model = topointer(L, 1);
+  double minimalStepSize = lua_tonumber(L, 2);
+  double maximalStepSize = lua_tonumber(L, 3);
+  oms_setStepSizeBounds(model, minimalStepSize, maximalStepSize);
+  return 0;
+}
+
+//void oms_setCouplingTolerance(void* model, double couplingTolerance);
+static int OMSimulatorLua_setCouplingTolerance(lua_State *L)
+{
+  if (lua_gettop(L) != 2)
+    return luaL_error(L, "expecting exactly 2 arguments");
+  luaL_checktype(L, 1, LUA_TUSERDATA);
+  luaL_checktype(L, 2, LUA_TNUMBER);
+
+  void *model = topointer(L, 1);
+  double couplingTolerance = lua_tonumber(L, 2);
+  oms_setCouplingTolerance(model, couplingTolerance);
+  return 0;
+}
+
 //void oms_logToStdStream(bool useStdStream);
 static int OMSimulatorLua_logToStdStream(lua_State *L)
 {
@@ -460,6 +975,31 @@ static int OMSimulatorLua_logToStdStream(lua_State *L)
   return 0;
 }
 
+//void oms_setTracing(int enable);
+static int OMSimulatorLua_setTracing(lua_State *L)
+{
+  if (lua_gettop(L) != 1)
+    return luaL_error(L, "expecting exactly 1 argument");
+  luaL_checktype(L, 1, LUA_TBOOLEAN);
+
+  int enable = lua_toboolean(L, 1);
+  oms_setTracing(enable);
+  return 0;
+}
+
+//oms_status_t oms_exportTrace(const char* filename);
+static int OMSimulatorLua_exportTrace(lua_State *L)
+{
+  if (lua_gettop(L) != 1)
+    return luaL_error(L, "expecting exactly 1 argument");
+  luaL_checktype(L, 1, LUA_TSTRING);
+
+  const char* filename = lua_tostring(L, 1);
+  oms_status_t returnValue = oms_exportTrace(filename);
+  lua_pushinteger(L, returnValue);
+  return 1;
+}
+
 //const char* oms_getVersion();
 static int OMSimulatorLua_getVersion(lua_State *L)
 {
@@ -511,15 +1051,23 @@ static int OMSimulatorLua_setVariableFilter(lua_State *L)
 DLLEXPORT int luaopen_OMSimulatorLua(lua_State *L)
 {
   REGISTER_LUA_CALL(addConnection);
+  REGISTER_LUA_CALL(cloneModel);
   REGISTER_LUA_CALL(compareSimulationResults);
   REGISTER_LUA_CALL(describe);
   REGISTER_LUA_CALL(doSteps);
   REGISTER_LUA_CALL(exportDependencyGraph);
+  REGISTER_LUA_CALL(exportTrace);
   REGISTER_LUA_CALL(exportXML);
+  REGISTER_LUA_CALL(freeSnapshot);
   REGISTER_LUA_CALL(getCurrentTime);
   REGISTER_LUA_CALL(getReal);
+  REGISTER_LUA_CALL(getRealByHandle);
+  REGISTER_LUA_CALL(getRealSensitivities);
+  REGISTER_LUA_CALL(getReals);
   REGISTER_LUA_CALL(getInteger);
   REGISTER_LUA_CALL(getBoolean);
+  REGISTER_LUA_CALL(getSolverStatistics);
+  REGISTER_LUA_CALL(getVariableHandle);
   REGISTER_LUA_CALL(getVersion);
   REGISTER_LUA_CALL(importXML);
   REGISTER_LUA_CALL(initialize);
@@ -527,22 +1075,42 @@ DLLEXPORT int luaopen_OMSimulatorLua(lua_State *L)
   REGISTER_LUA_CALL(loadModel);
   REGISTER_LUA_CALL(logToStdStream);
   REGISTER_LUA_CALL(newModel);
+  REGISTER_LUA_CALL(readSnapshot);
   REGISTER_LUA_CALL(reset);
+  REGISTER_LUA_CALL(restoreSnapshot);
+  REGISTER_LUA_CALL(runEnsemble);
+  REGISTER_LUA_CALL(saveSnapshot);
+  REGISTER_LUA_CALL(setAdaptiveStepSize);
+  REGISTER_LUA_CALL(setAlgLoopSolver);
+  REGISTER_LUA_CALL(setAsyncResultFile);
   REGISTER_LUA_CALL(setCommunicationInterval);
+  REGISTER_LUA_CALL(setCouplingTolerance);
+  REGISTER_LUA_CALL(setLinearSolver);
+  REGISTER_LUA_CALL(setMasterAlgorithm);
+  REGISTER_LUA_CALL(setNumProcs);
+  REGISTER_LUA_CALL(setPersistentFMUCache);
   REGISTER_LUA_CALL(setReal);
+  REGISTER_LUA_CALL(setRealByHandle);
+  REGISTER_LUA_CALL(setReals);
+  REGISTER_LUA_CALL(setInstanceCommunicationInterval);
   REGISTER_LUA_CALL(setInteger);
   REGISTER_LUA_CALL(setBoolean);
   REGISTER_LUA_CALL(setResultFile);
+  REGISTER_LUA_CALL(setSensitivityParameters);
   REGISTER_LUA_CALL(setSolverMethod);
+  REGISTER_LUA_CALL(setSolverOption);
   REGISTER_LUA_CALL(setStartTime);
+  REGISTER_LUA_CALL(setStepSizeBounds);
   REGISTER_LUA_CALL(setStopTime);
   REGISTER_LUA_CALL(setTempDirectory);
   REGISTER_LUA_CALL(setTolerance);
+  REGISTER_LUA_CALL(setTracing);
   REGISTER_LUA_CALL(setVariableFilter);
   REGISTER_LUA_CALL(setWorkingDirectory);
   REGISTER_LUA_CALL(simulate);
   REGISTER_LUA_CALL(stepUntil);
   REGISTER_LUA_CALL(terminate);
   REGISTER_LUA_CALL(unload);
+  REGISTER_LUA_CALL(writeSnapshot);
   return 0;
 }